@@ -0,0 +1,135 @@
+#include "benchmap.h"
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include "jsonpp.h"
+
+namespace
+{
+  char const* const RULES = R"({
+    "weapons": {
+      "0": {"id": 0, "name": "Rifle", "requireDeployed": false,
+            "rangeMap": {"1": 100}, "powerMap": {"0": 55, "1": 15, "2": 10}},
+      "1": {"id": 1, "name": "Cannon", "requireDeployed": false,
+            "rangeMap": {"1": 100}, "powerMap": {"0": 70, "1": 65, "2": 40}},
+      "2": {"id": 2, "name": "Artillery", "requireDeployed": true,
+            "rangeMap": {"2": 100, "3": 80}, "powerMap": {"0": 90, "1": 75, "2": 50}}
+    },
+    "armors": {
+      "0": {"id": 0, "name": "Personnel"},
+      "1": {"id": 1, "name": "Light"},
+      "2": {"id": 2, "name": "Air"}
+    },
+    "unitClasses": {
+      "0": {"id": 0, "name": "Infantry"},
+      "1": {"id": 1, "name": "Vehicle"},
+      "2": {"id": 2, "name": "Air"}
+    },
+    "terrainFlags": {},
+    "terrains": {
+      "0": {"id": 0, "name": "Plains", "defense": 10, "buildTypes": [], "repairTypes": [], "flags": []},
+      "1": {"id": 1, "name": "Forest", "defense": 30, "buildTypes": [], "repairTypes": [], "flags": []},
+      "2": {"id": 2, "name": "Mountain", "defense": 50, "buildTypes": [], "repairTypes": [], "flags": []},
+      "3": {"id": 3, "name": "Water", "defense": 0, "buildTypes": [], "repairTypes": [], "flags": []}
+    },
+    "movementTypes": {
+      "0": {"id": 0, "name": "Foot", "effectMap": {"2": 2, "3": null}},
+      "1": {"id": 1, "name": "Tread", "effectMap": {"1": 2, "2": null, "3": null}},
+      "2": {"id": 2, "name": "Air", "effectMap": {}}
+    },
+    "unitFlags": {},
+    "units": {
+      "0": {"id": 0, "name": "Infantry", "unitClass": 0, "price": 100, "primaryWeapon": 0, "secondaryWeapon": null,
+            "armor": 0, "defenseMap": {"1": 20, "2": 40}, "movementType": 0, "movement": 3,
+            "carryClasses": [], "carryNum": 0, "flags": []},
+      "1": {"id": 1, "name": "Tank", "unitClass": 1, "price": 700, "primaryWeapon": 1, "secondaryWeapon": 0,
+            "armor": 1, "defenseMap": {"1": 20}, "movementType": 1, "movement": 6,
+            "carryClasses": [], "carryNum": 0, "flags": []},
+      "2": {"id": 2, "name": "Artillery", "unitClass": 1, "price": 600, "primaryWeapon": 2, "secondaryWeapon": null,
+            "armor": 1, "defenseMap": {"1": 20}, "movementType": 1, "movement": 4,
+            "carryClasses": [], "carryNum": 0, "flags": []},
+      "3": {"id": 3, "name": "Copter", "unitClass": 2, "price": 900, "primaryWeapon": 1, "secondaryWeapon": null,
+            "armor": 2, "defenseMap": {}, "movementType": 2, "movement": 8,
+            "carryClasses": [0], "carryNum": 2, "flags": []}
+    }
+  })";
+
+  json::Value parseString(std::string const& content)
+  {
+    // Game only reads JSON through files, so round trip via the working directory
+    std::string path = "warshck-bench-map.json";
+    {
+      std::ofstream out(path);
+      if(!out)
+        throw std::runtime_error("Could not write " + path);
+      out << content;
+    }
+    json::Value value = json::Value::parseFile(path);
+    std::remove(path.data());
+    return value;
+  }
+}
+
+void wars::bench::loadMap(Game& game, int width, int height, int unitDensity, unsigned int seed,
+                          bool shuffleTiles)
+{
+  std::mt19937 random(seed);
+  std::uniform_int_distribution<int> percent(0, 99);
+  std::uniform_int_distribution<int> unitType(0, 3);
+
+  std::vector<std::string> tiles;
+  int numUnits = 0;
+  for(int y = 0; y < height; ++y)
+  {
+    for(int x = 0; x < width; ++x)
+    {
+      int roll = percent(random);
+      int terrain = roll < 55 ? 0 : roll < 75 ? 1 : roll < 88 ? 2 : 3;
+
+      std::ostringstream tile;
+      tile << R"({"tileId": "t)" << x << "_" << y << R"(", "x": )" << x << R"(, "y": )" << y
+           << R"(, "type": )" << terrain << R"(, "subtype": 0, "owner": 0, "capturePoints": 200, "beingCaptured": false)";
+
+      if(terrain != 3 && percent(random) < unitDensity)
+      {
+        int owner = 1 + numUnits % 2;
+        tile << R"(, "unitId": "u)" << numUnits << R"(", "unit": {"unitId": "u)" << numUnits
+             << R"(", "owner": )" << owner << R"(, "type": )" << unitType(random)
+             << R"(, "tileId": "t)" << x << "_" << y << R"(", "carriedBy": null, "health": 100,)"
+             << R"( "deployed": false, "moved": false, "capturing": false, "carriedUnits": []})";
+        numUnits += 1;
+      }
+      else
+      {
+        tile << R"(, "unitId": null)";
+      }
+      tile << "}";
+      tiles.push_back(tile.str());
+    }
+  }
+
+  // Own generator, the map is the same either way
+  if(shuffleTiles)
+    std::shuffle(tiles.begin(), tiles.end(), std::mt19937(seed));
+
+  std::ostringstream tileArray;
+  for(std::size_t i = 0; i < tiles.size(); ++i)
+    tileArray << (i > 0 ? "," : "") << tiles[i];
+
+  std::ostringstream data;
+  data << R"({"game": {"gameId": "bench", "authorId": "bench", "name": "bench", "mapId": "bench",)"
+       << R"( "state": "inProgress", "turnStart": 0, "turnNumber": 1, "roundNumber": 1, "inTurnNumber": 1,)"
+       << R"( "settings": {"public": false, "turnLength": null, "bannedUnits": []},)"
+       << R"( "players": [)"
+       << R"({"_id": "p1", "playerNumber": 1, "userId": null, "playerName": null, "teamNumber": 1, "funds": 0, "score": 0, "isMe": true},)"
+       << R"({"_id": "p2", "playerNumber": 2, "userId": null, "playerName": null, "teamNumber": 2, "funds": 0, "score": 0, "isMe": false}],)"
+       << R"( "tiles": [)" << tileArray.str() << "]}}";
+
+  game.setRulesFromJSON(parseString(RULES));
+  game.setGameDataFromJSON(parseString(data.str()));
+}
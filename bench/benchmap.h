@@ -0,0 +1,19 @@
+#ifndef WARS_BENCHMAP_H
+#define WARS_BENCHMAP_H
+
+#include "game.h"
+
+namespace wars
+{
+  namespace bench
+  {
+    // Loads deterministic rules and a width x height map into game. Terrain
+    // is plains, forest, mountain and water, roughly unitDensity percent of
+    // tiles hold a unit of one of two opposing players. Tiles are sent in
+    // row order, or in random order with shuffleTiles.
+    void loadMap(Game& game, int width, int height, int unitDensity = 10, unsigned int seed = 1,
+                 bool shuffleTiles = false);
+  }
+}
+
+#endif // WARS_BENCHMAP_H
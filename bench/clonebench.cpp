@@ -0,0 +1,60 @@
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+#include "game.h"
+#include "simstate.h"
+#include "benchmap.h"
+
+namespace
+{
+  void benchmark(int size, unsigned int numClones)
+  {
+    wars::Game game;
+    wars::bench::loadMap(game, size, size);
+
+    wars::SimState state(game);
+    wars::SimState clone(state);
+
+    wars::Game::UnitId unitId = 0;
+    while(!state.unitExists(unitId))
+      ++unitId;
+
+    wars::Game::Event event;
+    event.type = wars::Game::EventType::WAIT;
+    event.wait.unitId = unitId;
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned int moved = 0;
+    for(unsigned int i = 0; i < numClones; ++i)
+    {
+      clone = state;
+      clone.apply(event);
+      moved += clone.getUnit(unitId).flags & wars::Game::UNIT_MOVED ? 1 : 0;
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::size_t bytes = state.getStorageSize();
+    std::cout << size << "x" << size << ": " << bytes << " bytes, "
+              << numClones / seconds << " clones/s, "
+              << seconds * 1e9 / numClones << " ns/clone, "
+              << bytes * numClones / seconds / 1e9 << " GB/s"
+              << (moved == numClones ? "" : " (apply failed)") << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int numClones = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+  std::cout << "SimState clone and apply throughput" << std::endl;
+  // Fewer clones of larger maps, every size copies about as many bytes
+  benchmark(20, numClones);
+  benchmark(40, numClones / 4);
+  benchmark(100, std::max(numClones / 25, 1u));
+  benchmark(500, std::max(numClones / 625, 1u));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+
+#include "game.h"
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  double elapsedNs(Clock::time_point start)
+  {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  }
+
+  // Summed so the compiler cannot drop the work
+  long checksum(std::vector<int> const& values)
+  {
+    long sum = 0;
+    for(int value : values)
+      sum += value;
+    return sum;
+  }
+
+  void report(char const* name, std::size_t pairs, double ns, long sum)
+  {
+    std::cout << std::fixed << std::setprecision(3)
+              << "  " << std::left << std::setw(10) << name << std::right
+              << std::setw(9) << pairs / ns << " pairs/ns  (checksum " << sum << ")" << std::endl;
+  }
+
+  void benchmark(wars::Game const& game, std::size_t count, std::size_t numOrigins, unsigned int repeat)
+  {
+    std::mt19937 rng(count);
+    std::uniform_int_distribution<int> coordinate(-500, 500);
+    std::vector<int> xs(count);
+    std::vector<int> ys(count);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+      xs[i] = coordinate(rng);
+      ys[i] = coordinate(rng);
+    }
+    std::vector<int> originXs(numOrigins);
+    std::vector<int> originYs(numOrigins);
+    for(std::size_t i = 0; i < numOrigins; ++i)
+    {
+      originXs[i] = coordinate(rng);
+      originYs[i] = coordinate(rng);
+    }
+
+    std::size_t const pairs = count * numOrigins * repeat;
+    std::vector<int> scalar(count * numOrigins);
+    std::vector<int> batched(count * numOrigins);
+    std::vector<int> matrix(count * numOrigins);
+    std::cout << numOrigins << " origins x " << count << " positions x " << repeat << std::endl;
+
+    // One calculateDistance call per pair
+    auto start = Clock::now();
+    for(unsigned int r = 0; r < repeat; ++r)
+    {
+      for(std::size_t i = 0; i < numOrigins; ++i)
+      {
+        wars::Game::Coordinates const origin = {originXs[i], originYs[i]};
+        for(std::size_t j = 0; j < count; ++j)
+          scalar[i * count + j] = game.calculateDistance(origin, {xs[j], ys[j]});
+      }
+    }
+    report("scalar", pairs, elapsedNs(start), checksum(scalar));
+
+    start = Clock::now();
+    for(unsigned int r = 0; r < repeat; ++r)
+    {
+      for(std::size_t i = 0; i < numOrigins; ++i)
+        game.calculateDistances({originXs[i], originYs[i]}, xs.data(), ys.data(), batched.data() + i * count, count);
+    }
+    report("batched", pairs, elapsedNs(start), checksum(batched));
+
+    start = Clock::now();
+    for(unsigned int r = 0; r < repeat; ++r)
+    {
+      game.calculateDistanceMatrix(originXs.data(), originYs.data(), numOrigins, xs.data(), ys.data(), count,
+                                   matrix.data());
+    }
+    report("matrix", pairs, elapsedNs(start), checksum(matrix));
+
+    if(batched != scalar || matrix != scalar)
+    {
+      std::cerr << "Batched distances differ from calculateDistance" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int repeat = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 200;
+
+#if defined(__AVX2__)
+  std::cout << "Hex distance kernels, AVX2" << std::endl;
+#elif defined(__SSE2__)
+  std::cout << "Hex distance kernels, SSE2" << std::endl;
+#else
+  std::cout << "Hex distance kernels, scalar" << std::endl;
+#endif
+
+  // No map is needed, distance only depends on the topology
+  wars::Game game;
+  benchmark(game, 1000, 1, repeat * 100);
+  benchmark(game, 4096, 64, repeat);
+  benchmark(game, 100003, 4, repeat);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+#include "game.h"
+#include "threatmap.h"
+#include "benchmap.h"
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  double elapsedMs(Clock::time_point start)
+  {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  }
+
+  struct Layout
+  {
+    char const* name;
+    wars::Game::TileLayout layout;
+    bool shuffle;
+  };
+
+  Layout const LAYOUTS[] = {
+    {"rows", wars::Game::TileLayout::RECEIVED, false},
+    {"shuffled", wars::Game::TileLayout::RECEIVED, true},
+    {"morton", wars::Game::TileLayout::MORTON, true},
+    {"hilbert", wars::Game::TileLayout::HILBERT, true}
+  };
+
+  // Percentage of neighbouring tiles whose int columns share a 64 byte line
+  double neighbourLocality(wars::Game const& game)
+  {
+    wars::Game::TileStore const& tiles = game.getTiles();
+    std::size_t near = 0;
+    std::size_t count = 0;
+    for(wars::Game::TileId tileId = 0; tileId < tiles.size(); ++tileId)
+    {
+      for(wars::Game::Coordinates const& pos : game.neighborCoordinates({tiles.x[tileId], tiles.y[tileId]}))
+      {
+        wars::Game::TileId neighborId = game.getTileAt(pos.x, pos.y);
+        if(neighborId == wars::Game::NO_TILE)
+          continue;
+
+        near += neighborId / 16 == tileId / 16 ? 1 : 0;
+        count += 1;
+      }
+    }
+    return count > 0 ? 100.0 * near / count : 0;
+  }
+
+  void benchmark(int size, Layout const& layout, unsigned int numFields)
+  {
+    wars::Game game;
+    game.setTileLayout(layout.layout);
+    wars::bench::loadMap(game, size, size, 10, 1, layout.shuffle);
+
+    wars::Game::TileStore const& tiles = game.getTiles();
+    wars::Game::UnitStore const& units = game.getUnits();
+
+    // Whole map Dijkstra towards spread out targets, the field cache holds
+    // fewer than numFields so every one is computed
+    auto start = Clock::now();
+    for(unsigned int i = 0; i < numFields; ++i)
+    {
+      wars::Game::TileId targetId = game.getTileAt((i * 7919) % size, (i * 104729) % size);
+      game.getDistanceField(0, targetId, 1);
+    }
+    double fieldMs = elapsedMs(start) / numFields;
+
+    start = Clock::now();
+    std::size_t numOptions = 0;
+    for(int playerNumber : {1, 2})
+      numOptions += game.findAllMovementOptions(playerNumber).tileIds.size();
+    double movementMs = elapsedMs(start);
+
+    start = Clock::now();
+    std::size_t numAttacks = 0;
+    for(wars::Game::UnitId unitId = 0; unitId < units.size(); ++unitId)
+    {
+      wars::Game::TileId tileId = units.tileId[unitId];
+      if(units.exists(unitId) && tileId != wars::Game::NO_TILE)
+        numAttacks += game.findAttackOptions(unitId, {tiles.x[tileId], tiles.y[tileId]}).size();
+    }
+    double attackMs = elapsedMs(start);
+
+    // The first query computes every unit
+    start = Clock::now();
+    wars::ThreatMap threats(game);
+    int threatened = threats.attackers(1, game.getTileAt(size / 2, size / 2));
+    double threatMs = elapsedMs(start);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << size << "x" << size << " " << std::left << std::setw(9) << layout.name << std::right
+              << " local " << std::setw(6) << neighbourLocality(game) << "%"
+              << "  field " << std::setw(7) << fieldMs << " ms"
+              << "  movement " << std::setw(7) << movementMs << " ms (" << numOptions << ")"
+              << "  attacks " << std::setw(7) << attackMs << " ms (" << numAttacks << ")"
+              << "  threats " << std::setw(7) << threatMs << " ms (" << threatened << ")" << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int numFields = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 64;
+
+  std::cout << "Tile layouts, local is the share of neighbours within the same 16 TileIds" << std::endl;
+  for(int size : {200, 500, 1000})
+  {
+    for(Layout const& layout : LAYOUTS)
+      benchmark(size, layout, numFields);
+  }
+
+  return EXIT_SUCCESS;
+}
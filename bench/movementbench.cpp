@@ -0,0 +1,83 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <cstdlib>
+
+#include "game.h"
+#include "benchmap.h"
+
+namespace
+{
+  void benchmark(int size, unsigned int maxSamples)
+  {
+    wars::Game game;
+    wars::bench::loadMap(game, size, size);
+
+    wars::Game::UnitStore const& units = game.getUnits();
+    std::vector<wars::Game::UnitId> unitIds;
+    for(wars::Game::UnitId unitId = 0; unitId < units.size() && unitIds.size() < maxSamples; ++unitId)
+    {
+      if(units.exists(unitId) && units.tileId[unitId] != wars::Game::NO_TILE)
+        unitIds.push_back(unitId);
+    }
+
+    std::vector<double> samples;
+    std::size_t numOptions = 0;
+    for(wars::Game::UnitId unitId : unitIds)
+    {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<wars::Game::Coordinates> options = game.findMovementOptions(unitId);
+      auto end = std::chrono::steady_clock::now();
+      samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+      numOptions += options.size();
+    }
+
+    if(samples.empty())
+    {
+      std::cout << size << "x" << size << ": no units" << std::endl;
+      return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for(double sample : samples)
+      total += sample;
+
+    std::cout << size << "x" << size << ": " << samples.size() << " selections, "
+              << numOptions / samples.size() << " options avg, "
+              << "mean " << total / samples.size() << " us, "
+              << "median " << samples[samples.size() / 2] << " us, "
+              << "p99 " << samples[samples.size() * 99 / 100] << " us, "
+              << "max " << samples.back() << " us" << std::endl;
+
+    // Whole player at once, as at the start of a turn. Later calls reuse
+    // the per worker scratch space of the first.
+    for(int playerNumber : {1, 2})
+    {
+      wars::Game::MovementOptionSet options;
+      double ms[3];
+      for(double& callMs : ms)
+      {
+        auto start = std::chrono::steady_clock::now();
+        options = game.findAllMovementOptions(playerNumber);
+        auto end = std::chrono::steady_clock::now();
+        callMs = std::chrono::duration<double, std::milli>(end - start).count();
+      }
+      std::cout << size << "x" << size << ": findAllMovementOptions(" << playerNumber << ") "
+                << options.unitIds.size() << " units, " << options.tileIds.size() << " options in "
+                << ms[0] << " ms first, " << std::min(ms[1], ms[2]) << " ms repeated" << std::endl;
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  unsigned int maxSamples = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+  std::cout << "findMovementOptions selection latency" << std::endl;
+  benchmark(100, maxSamples);
+  benchmark(500, maxSamples);
+
+  return EXIT_SUCCESS;
+}
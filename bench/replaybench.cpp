@@ -0,0 +1,191 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include <sys/resource.h>
+
+#include "game.h"
+#include "eventlog.h"
+#include "loggerview.h"
+#include "jsonpp.h"
+
+namespace
+{
+  char const* const EVENT_TYPE_NAMES[] = {
+    "GAMEDATA", "MOVE", "WAIT", "ATTACK", "COUNTERATTACK", "CAPTURE", "CAPTURED",
+    "DEPLOY", "UNDEPLOY", "LOAD", "UNLOAD", "DESTROY", "REPAIR", "BUILD",
+    "REGENERATE_CAPTURE_POINTS", "PRODUCE_FUNDS", "BEGIN_TURN",
+    "END_TURN", "TURN_TIMEOUT", "FINISHED", "SURRENDER", "ROLLBACK"
+  };
+  std::size_t const NUM_EVENT_TYPES = sizeof(EVENT_TYPE_NAMES) / sizeof(EVENT_TYPE_NAMES[0]);
+
+  typedef std::chrono::steady_clock Clock;
+
+  double elapsedNs(Clock::time_point start, Clock::time_point end)
+  {
+    return std::chrono::duration<double, std::nano>(end - start).count();
+  }
+
+  long peakRssKb()
+  {
+    // ru_maxrss is in kilobytes on Linux
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  }
+
+  void usage(char const* program)
+  {
+    std::cerr << "Usage: " << program << " RULES GAMEDATA GAMEEVENTS [--repeat N] [--logger]" << std::endl
+              << "  RULES       rules JSON" << std::endl
+              << "  GAMEDATA    gameData response JSON" << std::endl
+              << "  GAMEEVENTS  JSON array of game events" << std::endl
+              << "  --repeat N  replay the events N times (default 10)" << std::endl
+              << "  --logger    attach LoggerView, its output goes to stdout" << std::endl
+              << "Results are written to stderr." << std::endl;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if(argc < 4)
+  {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  unsigned int repeat = 10;
+  bool attachLogger = false;
+  for(int i = 4; i < argc; ++i)
+  {
+    if(std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+    {
+      repeat = std::max(std::atoi(argv[++i]), 1);
+    }
+    else if(std::strcmp(argv[i], "--logger") == 0)
+    {
+      attachLogger = true;
+    }
+    else
+    {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  json::Value rules = json::Value::parseFile(argv[1]);
+  json::Value gameData = json::Value::parseFile(argv[2]);
+  json::Value gameEvents = json::Value::parseFile(argv[3]);
+  unsigned int numEvents = gameEvents.size();
+
+  wars::Game game;
+  game.setRulesFromJSON(rules);
+
+  wars::LoggerView logger;
+  if(attachLogger)
+    logger.setGame(&game);
+
+  // Counts every event pushed, a JSON event may push several (surrender)
+  std::size_t numPushed = 0;
+  wars::Game::EventType lastType = wars::Game::EventType::GAMEDATA;
+  auto countSub = game.events().on([&](wars::Game::Event const& event) {
+    numPushed += 1;
+    lastType = event.type;
+  });
+
+  // Whole stream through processEventsFromJSON
+  double totalNs = 0;
+  for(unsigned int i = 0; i < repeat; ++i)
+  {
+    game.setGameDataFromJSON(gameData);
+    auto start = Clock::now();
+    game.processEventsFromJSON(gameEvents);
+    totalNs += elapsedNs(start, Clock::now());
+  }
+
+  // One event at a time to attribute the cost to event types
+  std::vector<double> typeNs(NUM_EVENT_TYPES, 0);
+  std::vector<std::size_t> typeCount(NUM_EVENT_TYPES, 0);
+  for(unsigned int i = 0; i < repeat; ++i)
+  {
+    game.setGameDataFromJSON(gameData);
+    for(unsigned int j = 0; j < numEvents; ++j)
+    {
+      json::Value event = gameEvents.at(j);
+      std::size_t pushed = numPushed;
+      auto start = Clock::now();
+      game.processEventFromJSON(event);
+      double ns = elapsedNs(start, Clock::now());
+      if(numPushed == pushed)
+        continue;
+
+      std::size_t type = static_cast<std::size_t>(lastType);
+      typeNs[type] += ns;
+      typeCount[type] += 1;
+    }
+  }
+
+  // Same stream from the binary event log. Replaying must push the events
+  // pushed while recording, nested ones included, and nothing else.
+  std::vector<wars::Game::EventType> recordedTypes;
+  std::vector<wars::Game::EventType> replayedTypes;
+  std::vector<wars::Game::EventType>* pushedTypes = nullptr;
+  auto typeSub = game.events().on([&](wars::Game::Event const& event) {
+    if(pushedTypes != nullptr && event.type != wars::Game::EventType::GAMEDATA)
+      pushedTypes->push_back(event.type);
+  });
+
+  wars::EventLog log;
+  game.setGameDataFromJSON(gameData);
+  log.record(game);
+  pushedTypes = &recordedTypes;
+  game.processEventsFromJSON(gameEvents);
+  log.stop();
+
+  pushedTypes = &replayedTypes;
+  game.replay(log);
+  pushedTypes = nullptr;
+  if(replayedTypes != recordedTypes)
+  {
+    std::cerr << "EventLog replay pushed " << replayedTypes.size() << " events, recording pushed "
+              << recordedTypes.size() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  double replayNs = 0;
+  for(unsigned int i = 0; i < repeat; ++i)
+  {
+    auto start = Clock::now();
+    game.replay(log);
+    replayNs += elapsedNs(start, Clock::now());
+  }
+
+  std::size_t const numApplied = static_cast<std::size_t>(numEvents) * repeat;
+  std::cerr << std::fixed << std::setprecision(1)
+            << numEvents << " events x " << repeat << (attachLogger ? ", LoggerView attached" : ", no view") << std::endl
+            << "processEventsFromJSON: " << numApplied / (totalNs / 1e9) << " events/s, "
+            << totalNs / numApplied << " ns/event" << std::endl
+            << "EventLog replay (" << log.data().size() << " bytes, includes snapshot): "
+            << numApplied / (replayNs / 1e9) << " events/s, "
+            << replayNs / numApplied << " ns/event" << std::endl
+            << "ns/event by type:" << std::endl;
+
+  for(std::size_t type = 0; type < NUM_EVENT_TYPES; ++type)
+  {
+    if(typeCount[type] == 0)
+      continue;
+
+    std::cerr << "  " << std::left << std::setw(26) << EVENT_TYPE_NAMES[type] << std::right
+              << std::setw(10) << typeNs[type] / typeCount[type] << " ns  ("
+              << typeCount[type] / repeat << " events)" << std::endl;
+  }
+
+  std::cerr << "Peak RSS: " << peakRssKb() << " kB" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+#ifndef WARS_ASTAR_H
+#define WARS_ASTAR_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+namespace wars
+{
+  // A* search over a graph in CSR form (offsets/adjacency) using an indexed
+  // binary heap. Scratch buffers are kept between searches and invalidated
+  // with a generation stamp instead of being cleared.
+  //
+  // Policy must provide:
+  //   int cost(std::uint32_t node) const  - cost of entering node, negative if impassable
+  //   int maxCost() const                 - largest accepted total cost, negative for unlimited
+  //   int heuristic(std::uint32_t node) const - admissible estimate of remaining cost
+  class AStar
+  {
+  public:
+    typedef std::uint32_t Node;
+
+    AStar() : _generation(0), _stamp(), _cost(), _priority(), _from(), _heapIndex(), _heap()
+    {
+    }
+
+    // Fills path with nodes from start to goal inclusive, returns false and
+    // leaves path empty if goal cannot be reached
+    template<typename Policy>
+    bool search(std::vector<std::uint32_t> const& offsets, std::vector<Node> const& adjacency,
+                Node start, Node goal, Policy const& policy, std::vector<Node>& path);
+
+  private:
+    static Node const CLOSED = 0xffffffff;
+
+    void reset(std::size_t numNodes);
+    bool visited(Node node) const { return _stamp[node] == _generation; }
+    bool less(Node a, Node b) const;
+    void push(Node node);
+    void update(Node node);
+    Node pop();
+    void siftUp(std::size_t index);
+    void siftDown(std::size_t index);
+
+    std::uint32_t _generation;
+    std::vector<std::uint32_t> _stamp;
+    std::vector<int> _cost;
+    std::vector<int> _priority;
+    std::vector<Node> _from;
+    std::vector<Node> _heapIndex;
+    std::vector<Node> _heap;
+  };
+}
+
+template<typename Policy>
+bool wars::AStar::search(std::vector<std::uint32_t> const& offsets, std::vector<Node> const& adjacency,
+                         Node start, Node goal, Policy const& policy, std::vector<Node>& path)
+{
+  path.clear();
+  reset(offsets.size() - 1);
+
+  int const maxCost = policy.maxCost();
+
+  _stamp[start] = _generation;
+  _cost[start] = 0;
+  _priority[start] = policy.heuristic(start);
+  _from[start] = start;
+  push(start);
+
+  while(!_heap.empty())
+  {
+    Node node = pop();
+
+    // Check end condition
+    if(node == goal)
+    {
+      for(Node n = goal; n != start; n = _from[n])
+        path.push_back(n);
+      path.push_back(start);
+      std::reverse(path.begin(), path.end());
+      return true;
+    }
+
+    // Process neighbors
+    for(std::uint32_t i = offsets[node]; i < offsets[node + 1]; ++i)
+    {
+      Node neighbor = adjacency[i];
+
+      // Reject if already settled
+      bool known = visited(neighbor);
+      if(known && _heapIndex[neighbor] == CLOSED)
+        continue;
+
+      // Reject if cannot traverse
+      int stepCost = policy.cost(neighbor);
+      if(stepCost < 0)
+        continue;
+
+      // Reject if over budget or not shorter than a queued route
+      int cost = _cost[node] + stepCost;
+      if((maxCost >= 0 && cost > maxCost) || (known && cost >= _cost[neighbor]))
+        continue;
+
+      _from[neighbor] = node;
+      _cost[neighbor] = cost;
+      if(known)
+      {
+        _priority[neighbor] = cost + policy.heuristic(neighbor);
+        update(neighbor);
+      }
+      else
+      {
+        _stamp[neighbor] = _generation;
+        _priority[neighbor] = cost + policy.heuristic(neighbor);
+        push(neighbor);
+      }
+    }
+  }
+
+  return false;
+}
+
+inline void wars::AStar::reset(std::size_t numNodes)
+{
+  if(_stamp.size() < numNodes)
+  {
+    _stamp.resize(numNodes, _generation);
+    _cost.resize(numNodes);
+    _priority.resize(numNodes);
+    _from.resize(numNodes);
+    _heapIndex.resize(numNodes);
+  }
+
+  _heap.clear();
+  _generation += 1;
+  if(_generation == 0)
+  {
+    // Stamps wrapped around, start over
+    std::fill(_stamp.begin(), _stamp.end(), 0);
+    _generation = 1;
+  }
+}
+
+inline bool wars::AStar::less(Node a, Node b) const
+{
+  // Prefer deeper nodes on ties to reach the goal sooner
+  return _priority[a] < _priority[b] || (_priority[a] == _priority[b] && _cost[a] > _cost[b]);
+}
+
+inline void wars::AStar::push(Node node)
+{
+  _heapIndex[node] = _heap.size();
+  _heap.push_back(node);
+  siftUp(_heap.size() - 1);
+}
+
+inline void wars::AStar::update(Node node)
+{
+  // Priorities only ever decrease
+  siftUp(_heapIndex[node]);
+}
+
+inline wars::AStar::Node wars::AStar::pop()
+{
+  Node node = _heap.front();
+  _heapIndex[node] = CLOSED;
+
+  Node last = _heap.back();
+  _heap.pop_back();
+  if(!_heap.empty())
+  {
+    _heap.front() = last;
+    _heapIndex[last] = 0;
+    siftDown(0);
+  }
+
+  return node;
+}
+
+inline void wars::AStar::siftUp(std::size_t index)
+{
+  Node node = _heap[index];
+  while(index > 0)
+  {
+    std::size_t parent = (index - 1) / 2;
+    if(!less(node, _heap[parent]))
+      break;
+
+    _heap[index] = _heap[parent];
+    _heapIndex[_heap[index]] = index;
+    index = parent;
+  }
+  _heap[index] = node;
+  _heapIndex[node] = index;
+}
+
+inline void wars::AStar::siftDown(std::size_t index)
+{
+  Node node = _heap[index];
+  std::size_t size = _heap.size();
+  while(true)
+  {
+    std::size_t child = index * 2 + 1;
+    if(child >= size)
+      break;
+    if(child + 1 < size && less(_heap[child + 1], _heap[child]))
+      child += 1;
+    if(!less(_heap[child], node))
+      break;
+
+    _heap[index] = _heap[child];
+    _heapIndex[_heap[index]] = index;
+    index = child;
+  }
+  _heap[index] = node;
+  _heapIndex[node] = index;
+}
+
+#endif // WARS_ASTAR_H
@@ -0,0 +1,204 @@
+#include "bitboard.h"
+
+wars::Bitboard::Bitboard() :
+  originX(0), originY(0), numColumns(0), numRows(0), rowBits(1), words()
+{
+}
+
+wars::Bitboard::Bitboard(int minX, int minY, int width, int height) :
+  originX(minX), originY(minY), numColumns(width), numRows(height), rowBits(width + 1),
+  words((static_cast<std::size_t>(height) * (width + 1) + WORD_BITS - 1) / WORD_BITS, 0)
+{
+}
+
+int wars::Bitboard::minX() const
+{
+  return originX;
+}
+
+int wars::Bitboard::minY() const
+{
+  return originY;
+}
+
+int wars::Bitboard::width() const
+{
+  return numColumns;
+}
+
+int wars::Bitboard::height() const
+{
+  return numRows;
+}
+
+bool wars::Bitboard::sameArea(Bitboard const& other) const
+{
+  return originX == other.originX && originY == other.originY
+      && numColumns == other.numColumns && numRows == other.numRows;
+}
+
+bool wars::Bitboard::contains(int x, int y) const
+{
+  std::ptrdiff_t index = bit(x, y);
+  return index >= 0 && (words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+void wars::Bitboard::set(int x, int y)
+{
+  std::ptrdiff_t index = bit(x, y);
+  if(index >= 0)
+    words[index / WORD_BITS] |= std::uint64_t(1) << (index % WORD_BITS);
+}
+
+void wars::Bitboard::reset(int x, int y)
+{
+  std::ptrdiff_t index = bit(x, y);
+  if(index >= 0)
+    words[index / WORD_BITS] &= ~(std::uint64_t(1) << (index % WORD_BITS));
+}
+
+void wars::Bitboard::clear()
+{
+  words.assign(words.size(), 0);
+}
+
+void wars::Bitboard::clearArea(int x0, int y0, int x1, int y1)
+{
+  forEachAreaWord(x0, y0, x1, y1, [&](std::size_t i, std::uint64_t bits) {
+    words[i] &= ~bits;
+  });
+}
+
+std::size_t wars::Bitboard::count() const
+{
+  std::size_t result = 0;
+  for(std::uint64_t word : words)
+  {
+    result += __builtin_popcountll(word);
+  }
+  return result;
+}
+
+bool wars::Bitboard::empty() const
+{
+  for(std::uint64_t word : words)
+  {
+    if(word != 0)
+      return false;
+  }
+  return true;
+}
+
+bool wars::Bitboard::intersects(Bitboard const& other) const
+{
+  for(std::size_t i = 0; i < words.size(); ++i)
+  {
+    if(words[i] & other.words.at(i))
+      return true;
+  }
+  return false;
+}
+
+wars::Bitboard& wars::Bitboard::operator&=(Bitboard const& other)
+{
+  for(std::size_t i = 0; i < words.size(); ++i)
+  {
+    words[i] &= other.words.at(i);
+  }
+  return *this;
+}
+
+wars::Bitboard& wars::Bitboard::operator|=(Bitboard const& other)
+{
+  for(std::size_t i = 0; i < words.size(); ++i)
+  {
+    words[i] |= other.words.at(i);
+  }
+  return *this;
+}
+
+wars::Bitboard& wars::Bitboard::subtract(Bitboard const& other)
+{
+  for(std::size_t i = 0; i < words.size(); ++i)
+  {
+    words[i] &= ~other.words.at(i);
+  }
+  return *this;
+}
+
+std::ptrdiff_t wars::Bitboard::bit(int x, int y) const
+{
+  int column = x - originX;
+  int row = y - originY;
+  if(column < 0 || row < 0 || column >= numColumns || row >= numRows)
+    return -1;
+
+  return static_cast<std::ptrdiff_t>(row) * rowBits + column;
+}
+
+void wars::Bitboard::flood(Bitboard const& mask, Bitboard const& blocked, int steps, int x0, int y0, int x1, int y1,
+                           std::ptrdiff_t const* shifts, int numShifts)
+{
+  if(!sameArea(mask) || !sameArea(blocked))
+    return;
+
+  // Words of the area and the cells of each a step may add, a word shared
+  // by two rows is listed once
+  std::vector<std::size_t> areaWords;
+  std::vector<std::uint64_t> open;
+  forEachAreaWord(x0, y0, x1, y1, [&](std::size_t i, std::uint64_t bits) {
+    if(areaWords.empty() || areaWords.back() != i)
+    {
+      areaWords.push_back(i);
+      open.push_back(0);
+    }
+    open.back() |= bits & mask.words[i] & ~blocked.words[i];
+  });
+
+  // Bit j of word i of a set shifted by shift is source bit i * 64 + j - shift,
+  // the source starts sourceWords[s] words and sourceBits[s] bits from word i
+  std::vector<std::ptrdiff_t> sourceWords(numShifts);
+  std::vector<int> sourceBits(numShifts);
+  for(int s = 0; s < numShifts; ++s)
+  {
+    std::ptrdiff_t offset = -shifts[s];
+    sourceWords[s] = offset >= 0 ? offset / WORD_BITS : -((WORD_BITS - 1 - offset) / WORD_BITS);
+    sourceBits[s] = offset - sourceWords[s] * WORD_BITS;
+  }
+
+  std::ptrdiff_t const numWords = words.size();
+  std::vector<std::uint64_t> grown(areaWords.size());
+  for(int step = 0; step < steps; ++step)
+  {
+    // Every shift reads the set as it was before the step
+    bool changed = false;
+    for(std::size_t k = 0; k < areaWords.size(); ++k)
+    {
+      std::size_t i = areaWords[k];
+      grown[k] = words[i];
+      if(open[k] == 0)
+        continue;
+
+      std::uint64_t reached = 0;
+      for(int s = 0; s < numShifts; ++s)
+      {
+        std::ptrdiff_t w = i + sourceWords[s];
+        int b = sourceBits[s];
+        std::uint64_t low = w >= 0 && w < numWords ? words[w] : 0;
+        std::uint64_t high = w + 1 >= 0 && w + 1 < numWords ? words[w + 1] : 0;
+        reached |= b == 0 ? low : (low >> b) | (high << (WORD_BITS - b));
+      }
+
+      grown[k] |= reached & open[k];
+      changed = changed || grown[k] != words[i];
+    }
+
+    if(!changed)
+      break;
+
+    for(std::size_t k = 0; k < areaWords.size(); ++k)
+    {
+      words[areaWords[k]] = grown[k];
+    }
+  }
+}
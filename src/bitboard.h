@@ -0,0 +1,135 @@
+#ifndef WARS_BITBOARD_H
+#define WARS_BITBOARD_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace wars
+{
+  // Set of cells of a rectangular map area, one bit per cell in row major
+  // order. Rows are one bit longer than the area so a cell shifted past
+  // either edge lands in that spare column instead of the next row. The
+  // spare column is never set, masks keep it out of flood fills. Boards
+  // combined with each other must cover the same area.
+  class Bitboard
+  {
+  public:
+    Bitboard();
+    Bitboard(int minX, int minY, int width, int height);
+
+    int minX() const;
+    int minY() const;
+    int width() const;
+    int height() const;
+    bool sameArea(Bitboard const& other) const;
+
+    // Out of area cells are not in the set and cannot be added
+    bool contains(int x, int y) const;
+    void set(int x, int y);
+    void reset(int x, int y);
+    void clear();
+    // Clears the cells from (x0, y0) to (x1, y1) inclusive
+    void clearArea(int x0, int y0, int x1, int y1);
+
+    std::size_t count() const;
+    bool empty() const;
+    bool intersects(Bitboard const& other) const;
+
+    Bitboard& operator&=(Bitboard const& other);
+    Bitboard& operator|=(Bitboard const& other);
+    // Removes the cells of other
+    Bitboard& subtract(Bitboard const& other);
+
+    // Calls f(x, y) for each cell in the set in row major order
+    template<typename F>
+    void forEach(F f) const;
+    // Same for the cells from (x0, y0) to (x1, y1) inclusive
+    template<typename F>
+    void forEachInArea(int x0, int y0, int x1, int y1, F f) const;
+
+    // Grows the set by one cell towards each Topology direction, steps times
+    // or until it stops growing. Only cells in mask and not in blocked are
+    // added. Growth stays within (x0, y0) .. (x1, y1), the area should hold
+    // every cell already in the set. Cost is proportional to the area, not
+    // the board.
+    template<typename Topology>
+    void flood(Bitboard const& mask, Bitboard const& blocked, int steps, int x0, int y0, int x1, int y1);
+
+  private:
+    static int const WORD_BITS = 64;
+
+    std::ptrdiff_t bit(int x, int y) const;
+    // Calls f(word index, bits of the word in the area) row by row, clipped
+    // to the board. A word spanning two rows is visited for each.
+    template<typename F>
+    void forEachAreaWord(int x0, int y0, int x1, int y1, F f) const;
+    void flood(Bitboard const& mask, Bitboard const& blocked, int steps, int x0, int y0, int x1, int y1,
+               std::ptrdiff_t const* shifts, int numShifts);
+
+    int originX;
+    int originY;
+    int numColumns;
+    int numRows;
+    int rowBits; // numColumns + 1
+    std::vector<std::uint64_t> words;
+  };
+}
+
+template<typename F>
+void wars::Bitboard::forEach(F f) const
+{
+  forEachInArea(originX, originY, originX + numColumns - 1, originY + numRows - 1, f);
+}
+
+template<typename F>
+void wars::Bitboard::forEachInArea(int x0, int y0, int x1, int y1, F f) const
+{
+  forEachAreaWord(x0, y0, x1, y1, [&](std::size_t i, std::uint64_t bits) {
+    // Lowest set bit first, cleared as it is visited
+    for(std::uint64_t word = words[i] & bits; word != 0; word &= word - 1)
+    {
+      std::size_t index = i * WORD_BITS + __builtin_ctzll(word);
+      f(originX + static_cast<int>(index % rowBits), originY + static_cast<int>(index / rowBits));
+    }
+  });
+}
+
+template<typename Topology>
+void wars::Bitboard::flood(Bitboard const& mask, Bitboard const& blocked, int steps, int x0, int y0, int x1, int y1)
+{
+  // A direction is a fixed bit offset in row major order
+  std::ptrdiff_t shifts[Topology::NUM_DIRECTIONS];
+  for(int i = 0; i < Topology::NUM_DIRECTIONS; ++i)
+    shifts[i] = Topology::DIRECTIONS[i][0] + static_cast<std::ptrdiff_t>(Topology::DIRECTIONS[i][1]) * rowBits;
+
+  flood(mask, blocked, steps, x0, y0, x1, y1, shifts, Topology::NUM_DIRECTIONS);
+}
+
+template<typename F>
+void wars::Bitboard::forEachAreaWord(int x0, int y0, int x1, int y1, F f) const
+{
+  int firstColumn = x0 > originX ? x0 - originX : 0;
+  int lastColumn = x1 - originX < numColumns ? x1 - originX : numColumns - 1;
+  int firstRow = y0 > originY ? y0 - originY : 0;
+  int lastRow = y1 - originY < numRows ? y1 - originY : numRows - 1;
+  if(firstColumn > lastColumn)
+    return;
+
+  for(int row = firstRow; row <= lastRow; ++row)
+  {
+    std::size_t begin = static_cast<std::size_t>(row) * rowBits + firstColumn;
+    std::size_t end = static_cast<std::size_t>(row) * rowBits + lastColumn + 1;
+    for(std::size_t i = begin / WORD_BITS; i * WORD_BITS < end; ++i)
+    {
+      std::uint64_t bits = ~std::uint64_t(0);
+      if(begin > i * WORD_BITS)
+        bits <<= begin - i * WORD_BITS;
+      if(end < (i + 1) * WORD_BITS)
+        bits &= ~std::uint64_t(0) >> ((i + 1) * WORD_BITS - end);
+      f(i, bits);
+    }
+  }
+}
+
+#endif // WARS_BITBOARD_H
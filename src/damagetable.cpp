@@ -0,0 +1,216 @@
+#include "damagetable.h"
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+  int const UNKNOWN_TERRAIN = std::numeric_limits<int>::min();
+
+  template<typename T>
+  int idLimit(std::unordered_map<int, T> const& items)
+  {
+    int limit = 0;
+    for(auto const& item : items)
+    {
+      limit = std::max(limit, item.first + 1);
+    }
+    return limit;
+  }
+}
+
+wars::DamageTable::DamageTable() :
+  numUnitTypes(0), numTerrainTypes(0), numDistances(0), powers(), defenses()
+{
+}
+
+void wars::DamageTable::compile(Rules const& rules)
+{
+  numUnitTypes = idLimit(rules.unitTypes);
+  numTerrainTypes = idLimit(rules.terrainTypes);
+
+  numDistances = 0;
+  for(auto const& item : rules.weapons)
+  {
+    for(auto const& range : item.second.rangeMap)
+    {
+      numDistances = std::max(numDistances, range.first + 1);
+    }
+  }
+
+  powers.assign(numUnitTypes * 2 * numUnitTypes * numDistances, -1);
+  defenses.assign(numUnitTypes * numTerrainTypes, UNKNOWN_TERRAIN);
+
+  for(auto const& attacker : rules.unitTypes)
+  {
+    UnitType const& attackerType = attacker.second;
+    int weaponIds[] = {attackerType.primaryWeapon, attackerType.secondaryWeapon};
+
+    for(int weaponId : weaponIds)
+    {
+      auto weaponIter = rules.weapons.find(weaponId);
+      if(weaponIter == rules.weapons.end())
+        continue;
+
+      Weapon const& weapon = weaponIter->second;
+      for(auto const& target : rules.unitTypes)
+      {
+        auto powerIter = weapon.powerMap.find(target.second.armor);
+        if(powerIter == weapon.powerMap.end())
+          continue;
+
+        for(auto const& range : weapon.rangeMap)
+        {
+          if(range.first < 0)
+            continue;
+
+          int weaponPower = powerIter->second * range.second / 100;
+          for(int deployed = weapon.requireDeployed ? 1 : 0; deployed < 2; ++deployed)
+          {
+            int& power = powers[powerIndex(attacker.first, deployed, target.first, range.first)];
+            power = std::max(power, weaponPower);
+          }
+        }
+      }
+    }
+  }
+
+  for(auto const& target : rules.unitTypes)
+  {
+    UnitType const& targetType = target.second;
+    for(auto const& terrain : rules.terrainTypes)
+    {
+      auto defenseIter = targetType.defenseMap.find(terrain.first);
+      int defense = defenseIter != targetType.defenseMap.end() ? defenseIter->second : terrain.second.defense;
+      defenses[target.first * numTerrainTypes + terrain.first] = defense;
+    }
+  }
+}
+
+int wars::DamageTable::power(int attackerTypeId, bool attackerDeployed, int targetTypeId, int distance) const
+{
+  if(attackerTypeId < 0 || attackerTypeId >= numUnitTypes
+     || targetTypeId < 0 || targetTypeId >= numUnitTypes
+     || distance < 0 || distance >= numDistances)
+    return -1;
+
+  return powers[powerIndex(attackerTypeId, attackerDeployed, targetTypeId, distance)];
+}
+
+int wars::DamageTable::maxPower(int attackerTypeId, bool attackerDeployed, int distance) const
+{
+  int result = -1;
+  for(int targetTypeId = 0; targetTypeId < numUnitTypes; ++targetTypeId)
+  {
+    result = std::max(result, power(attackerTypeId, attackerDeployed, targetTypeId, distance));
+  }
+  return result;
+}
+
+int wars::DamageTable::defense(int targetTypeId, int terrainId) const
+{
+  int defense = UNKNOWN_TERRAIN;
+  if(targetTypeId >= 0 && targetTypeId < numUnitTypes && terrainId >= 0 && terrainId < numTerrainTypes)
+    defense = defenses[targetTypeId * numTerrainTypes + terrainId];
+
+  if(defense == UNKNOWN_TERRAIN)
+    throw std::out_of_range("Unknown terrain type");
+
+  return defense;
+}
+
+int wars::DamageTable::damage(int attackerTypeId, int attackerHealth, bool attackerDeployed,
+                              int targetTypeId, int targetHealth, int distance, int terrainId) const
+{
+  // Reject if cannot attack
+  int power = this->power(attackerTypeId, attackerDeployed, targetTypeId, distance);
+  if(power < 0)
+    return -1;
+
+  return damage(attackerHealth, targetHealth, power, this->defense(targetTypeId, terrainId));
+}
+
+int wars::DamageTable::damage(int attackerHealth, int targetHealth, int power, int defense)
+{
+  // Reject if cannot attack
+  if(power < 0)
+    return -1;
+
+  // Calculate damage
+  int damage = attackerHealth * power * (100 - (defense * targetHealth / 100)) / 100 / 100;
+
+  // Minimum damage is 1
+  return std::max(damage, 1);
+}
+
+/* The vector kernels evaluate the formula in double precision lanes. Every
+ * intermediate of the integer formula fits in an int, so the products are
+ * exact in a double and a division by 100 or 10000 lands far enough from
+ * the next integer that truncating it matches integer division, including
+ * its rounding towards zero. (n / 100) / 100 == n / 10000 for integers. */
+void wars::DamageTable::damages(int const* attackerHealth, int const* targetHealth, int const* power,
+                                int const* defense, int* damage, std::size_t count)
+{
+  std::size_t i = 0;
+
+#if defined(__AVX2__)
+  __m256d const hundred = _mm256_set1_pd(100.0);
+  __m256d const tenThousand = _mm256_set1_pd(10000.0);
+  __m256d const one = _mm256_set1_pd(1.0);
+  __m256d const minusOne = _mm256_set1_pd(-1.0);
+  __m256d const zero = _mm256_setzero_pd();
+
+  for(; i + 4 <= count; i += 4)
+  {
+    __m256d ah = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<__m128i const*>(attackerHealth + i)));
+    __m256d th = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<__m128i const*>(targetHealth + i)));
+    __m256d p = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<__m128i const*>(power + i)));
+    __m256d d = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<__m128i const*>(defense + i)));
+
+    __m256d effective = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(_mm256_div_pd(_mm256_mul_pd(d, th), hundred)));
+    __m256d n = _mm256_mul_pd(_mm256_mul_pd(ah, p), _mm256_sub_pd(hundred, effective));
+    __m256d result = _mm256_max_pd(_mm256_div_pd(n, tenThousand), one);
+    result = _mm256_blendv_pd(result, minusOne, _mm256_cmp_pd(p, zero, _CMP_LT_OQ));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(damage + i), _mm256_cvttpd_epi32(result));
+  }
+#elif defined(__SSE2__)
+  __m128d const hundred = _mm_set1_pd(100.0);
+  __m128d const tenThousand = _mm_set1_pd(10000.0);
+  __m128d const one = _mm_set1_pd(1.0);
+  __m128d const minusOne = _mm_set1_pd(-1.0);
+  __m128d const zero = _mm_setzero_pd();
+
+  for(; i + 2 <= count; i += 2)
+  {
+    __m128d ah = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(attackerHealth + i)));
+    __m128d th = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(targetHealth + i)));
+    __m128d p = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(power + i)));
+    __m128d d = _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(defense + i)));
+
+    __m128d effective = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_div_pd(_mm_mul_pd(d, th), hundred)));
+    __m128d n = _mm_mul_pd(_mm_mul_pd(ah, p), _mm_sub_pd(hundred, effective));
+    __m128d result = _mm_max_pd(_mm_div_pd(n, tenThousand), one);
+    __m128d reject = _mm_cmplt_pd(p, zero);
+    result = _mm_or_pd(_mm_and_pd(reject, minusOne), _mm_andnot_pd(reject, result));
+
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(damage + i), _mm_cvttpd_epi32(result));
+  }
+#endif
+
+  for(; i < count; ++i)
+  {
+    damage[i] = DamageTable::damage(attackerHealth[i], targetHealth[i], power[i], defense[i]);
+  }
+}
+
+int wars::DamageTable::powerIndex(int attackerTypeId, bool attackerDeployed, int targetTypeId, int distance) const
+{
+  return ((attackerTypeId * 2 + (attackerDeployed ? 1 : 0)) * numUnitTypes + targetTypeId) * numDistances + distance;
+}
@@ -0,0 +1,47 @@
+#ifndef WARS_DAMAGETABLE_H
+#define WARS_DAMAGETABLE_H
+
+#include <vector>
+#include <cstddef>
+#include "rules.h"
+
+namespace wars
+{
+  // Attack power and defense compiled from Rules into dense tables indexed
+  // by rule IDs, so evaluating an attack needs no hash lookups
+  class DamageTable
+  {
+  public:
+    DamageTable();
+
+    void compile(Rules const& rules);
+
+    // Best usable weapon power against target type at distance, -1 if none
+    int power(int attackerTypeId, bool attackerDeployed, int targetTypeId, int distance) const;
+    // Best usable weapon power against any target type at distance, -1 if none
+    int maxPower(int attackerTypeId, bool attackerDeployed, int distance) const;
+    // Defense of target type on terrain, throws std::out_of_range on unknown terrain
+    int defense(int targetTypeId, int terrainId) const;
+    // Same as Game::calculateAttackDamage, -1 if the attack is not possible
+    int damage(int attackerTypeId, int attackerHealth, bool attackerDeployed,
+               int targetTypeId, int targetHealth, int distance, int terrainId) const;
+
+    // Damage formula for a single precomputed power and defense
+    static int damage(int attackerHealth, int targetHealth, int power, int defense);
+    // Damage formula over count packed entries using SSE2/AVX2 when available,
+    // results are identical to the scalar formula
+    static void damages(int const* attackerHealth, int const* targetHealth, int const* power,
+                        int const* defense, int* damage, std::size_t count);
+
+  private:
+    int powerIndex(int attackerTypeId, bool attackerDeployed, int targetTypeId, int distance) const;
+
+    int numUnitTypes;
+    int numTerrainTypes;
+    int numDistances;
+    std::vector<int> powers; // [attacker][deployed][target][distance]
+    std::vector<int> defenses; // [target][terrain]
+  };
+}
+
+#endif // WARS_DAMAGETABLE_H
@@ -0,0 +1,867 @@
+#include "eventlog.h"
+#include <stdexcept>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+  char const MAGIC[] = {'W', 'A', 'R', 'S', 'L', 'O', 'G', '1'};
+
+  // Bounds checked decoding, reads past the end clear ok instead of throwing
+  // so that a record cut short by a crash can be told apart from a bad file
+  class Reader
+  {
+  public:
+    Reader(std::vector<std::uint8_t> const& data, std::size_t pos) :
+      data(data), pos(pos), ok(true)
+    {
+    }
+
+    bool atEnd() const { return pos >= data.size(); }
+    bool good() const { return ok; }
+    std::size_t position() const { return pos; }
+
+    std::uint8_t getByte();
+    std::uint64_t getUnsigned();
+    std::int64_t getSigned();
+    wars::Handle getHandle();
+    double getDouble();
+    std::string getString();
+
+  private:
+    std::vector<std::uint8_t> const& data;
+    std::size_t pos;
+    bool ok;
+  };
+
+  struct Snapshot
+  {
+    std::string gameId;
+    std::string authorId;
+    std::string name;
+    std::string mapId;
+    wars::Game::State state;
+    double turnStart;
+    int turnNumber;
+    int roundNumber;
+    int inTurnNumber;
+    bool publicGame;
+    double turnLength;
+    std::unordered_set<int> bannedUnits;
+    std::vector<std::string> tileIds;
+    std::vector<std::string> unitIds;
+    wars::Game::TileStore tiles;
+    wars::Game::UnitStore units;
+    std::unordered_map<int, wars::Game::Player> players;
+  };
+
+  void readSnapshot(Reader& reader, Snapshot& snapshot);
+}
+
+wars::EventLog::EventLog() :
+  game(nullptr), eventSub(), buffer(MAGIC, MAGIC + sizeof(MAGIC)), file(nullptr), flushed(0),
+  tileIdsWritten(0), unitIdsWritten(0)
+{
+}
+
+wars::EventLog::~EventLog()
+{
+  stop();
+  close();
+}
+
+void wars::EventLog::load(std::string const& path)
+{
+  std::FILE* in = std::fopen(path.c_str(), "rb");
+  if(!in)
+    throw std::runtime_error("Cannot open event log " + path);
+
+  std::vector<std::uint8_t> data;
+  std::uint8_t chunk[65536];
+  std::size_t count;
+  while((count = std::fread(chunk, 1, sizeof(chunk), in)) > 0)
+  {
+    data.insert(data.end(), chunk, chunk + count);
+  }
+  bool failed = std::ferror(in);
+  std::fclose(in);
+
+  if(failed)
+    throw std::runtime_error("Cannot read event log " + path);
+  if(data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+    throw std::runtime_error("Not an event log: " + path);
+
+  buffer.swap(data);
+  flushed = 0;
+}
+
+void wars::EventLog::open(std::string const& path)
+{
+  close();
+  file = std::fopen(path.c_str(), "wb");
+  if(!file)
+    throw std::runtime_error("Cannot open event log " + path);
+
+  flushed = 0;
+  flush();
+}
+
+void wars::EventLog::close()
+{
+  if(file)
+  {
+    std::fclose(file);
+    file = nullptr;
+  }
+}
+
+void wars::EventLog::record(Game& game)
+{
+  stop();
+  this->game = &game;
+  eventSub = game.events().on([this](Game::Event const& event) {
+    handleEvent(event);
+  });
+
+  if(game.getTiles().size() > 0)
+  {
+    writeSnapshot();
+    flush();
+  }
+}
+
+void wars::EventLog::stop()
+{
+  eventSub.unsubscribe();
+  game = nullptr;
+}
+
+std::vector<std::uint8_t> const& wars::EventLog::data() const
+{
+  return buffer;
+}
+
+void wars::EventLog::handleEvent(Game::Event const& event)
+{
+  // GAMEDATA and ROLLBACK come after the state changed, everything else before
+  if(event.type == Game::EventType::GAMEDATA)
+  {
+    writeSnapshot();
+    flush();
+    return;
+  }
+
+  // Replaying the outer event pushes the nested ones again
+  if(game->eventDepth > 0)
+    return;
+
+  writeIds();
+  buffer.push_back(static_cast<std::uint8_t>(RecordType::EVENT));
+  buffer.push_back(static_cast<std::uint8_t>(event.type));
+
+  switch(event.type)
+  {
+    case Game::EventType::MOVE:
+    {
+      putHandle(event.move.unitId);
+      putHandle(event.move.tileId);
+      putUnsigned(event.move.path->size());
+      for(Game::Coordinates const& pos : *event.move.path)
+      {
+        putSigned(pos.x);
+        putSigned(pos.y);
+      }
+      break;
+    }
+    case Game::EventType::WAIT:
+      putHandle(event.wait.unitId);
+      break;
+    case Game::EventType::ATTACK:
+      putHandle(event.attack.attackerId);
+      putHandle(event.attack.targetId);
+      putSigned(event.attack.damage);
+      break;
+    case Game::EventType::COUNTERATTACK:
+      putHandle(event.counterattack.attackerId);
+      putHandle(event.counterattack.targetId);
+      putSigned(event.counterattack.damage);
+      break;
+    case Game::EventType::CAPTURE:
+      putHandle(event.capture.unitId);
+      putHandle(event.capture.tileId);
+      putSigned(event.capture.left);
+      break;
+    case Game::EventType::CAPTURED:
+      putHandle(event.captured.unitId);
+      putHandle(event.captured.tileId);
+      break;
+    case Game::EventType::DEPLOY:
+      putHandle(event.deploy.unitId);
+      break;
+    case Game::EventType::UNDEPLOY:
+      putHandle(event.undeploy.unitId);
+      break;
+    case Game::EventType::LOAD:
+      putHandle(event.load.unitId);
+      putHandle(event.load.carrierId);
+      break;
+    case Game::EventType::UNLOAD:
+      putHandle(event.unload.unitId);
+      putHandle(event.unload.carrierId);
+      putHandle(event.unload.tileId);
+      break;
+    case Game::EventType::DESTROY:
+      putHandle(event.destroy.unitId);
+      break;
+    case Game::EventType::REPAIR:
+      putHandle(event.repair.unitId);
+      putSigned(event.repair.newHealth);
+      break;
+    case Game::EventType::BUILD:
+      putHandle(event.build.tileId);
+      putHandle(event.build.unitId);
+      putSigned(event.build.unitType);
+      putSigned(event.build.owner);
+      putSigned(event.build.health);
+      break;
+    case Game::EventType::REGENERATE_CAPTURE_POINTS:
+      putHandle(event.regenerateCapturePoints.tileId);
+      putSigned(event.regenerateCapturePoints.newCapturePoints);
+      break;
+    case Game::EventType::PRODUCE_FUNDS:
+      putHandle(event.produceFunds.tileId);
+      break;
+    case Game::EventType::BEGIN_TURN:
+      putSigned(event.beginTurn.playerNumber);
+      break;
+    case Game::EventType::END_TURN:
+      putSigned(event.endTurn.playerNumber);
+      break;
+    case Game::EventType::TURN_TIMEOUT:
+      putSigned(event.turnTimeout.playerNumber);
+      break;
+    case Game::EventType::FINISHED:
+      putSigned(event.finished.winnerPlayerNumber);
+      break;
+    case Game::EventType::SURRENDER:
+      putSigned(event.surrender.playerNumber);
+      break;
+    case Game::EventType::ROLLBACK:
+    {
+      // The reverted state itself, only what the rollback touched
+      putUnsigned(static_cast<unsigned int>(game->state));
+      putSigned(game->inTurnNumber);
+
+      Game::TileStore const& tiles = game->tiles;
+      putUnsigned(event.rollback.numTileIds);
+      for(std::size_t i = 0; i < event.rollback.numTileIds; ++i)
+      {
+        Game::TileId tileId = event.rollback.tileIds[i];
+        putHandle(tileId);
+        putSigned(tiles.owner[tileId]);
+        putHandle(tiles.unitId[tileId]);
+        putSigned(tiles.capturePoints[tileId]);
+        putUnsigned(tiles.beingCaptured[tileId]);
+      }
+
+      Game::UnitStore const& units = game->units;
+      putUnsigned(event.rollback.numUnitIds);
+      for(std::size_t i = 0; i < event.rollback.numUnitIds; ++i)
+      {
+        Game::UnitId unitId = event.rollback.unitIds[i];
+        putHandle(unitId);
+        putHandle(units.tileId[unitId]);
+        putSigned(units.type[unitId]);
+        putSigned(units.owner[unitId]);
+        putSigned(units.health[unitId]);
+        putHandle(units.carriedBy[unitId]);
+        putUnsigned(units.flags[unitId] | (units.moved(unitId) ? Game::UNIT_MOVED : 0));
+        putUnsigned(units.carriedUnits[unitId].size());
+        for(Game::UnitId carriedId : units.carriedUnits[unitId])
+          putHandle(carriedId);
+      }
+      break;
+    }
+    case Game::EventType::GAMEDATA:
+      break;
+  }
+
+  flush();
+}
+
+void wars::EventLog::writeSnapshot()
+{
+  buffer.push_back(static_cast<std::uint8_t>(RecordType::SNAPSHOT));
+
+  putString(game->gameId);
+  putString(game->authorId);
+  putString(game->name);
+  putString(game->mapId);
+  putUnsigned(static_cast<unsigned int>(game->state));
+  putDouble(game->turnStart);
+  putSigned(game->turnNumber);
+  putSigned(game->roundNumber);
+  putSigned(game->inTurnNumber);
+  putUnsigned(game->publicGame);
+  putDouble(game->turnLength);
+  putUnsigned(game->bannedUnits.size());
+  for(int unitType : game->bannedUnits)
+    putSigned(unitType);
+
+  putUnsigned(game->tileIds.size());
+  for(Handle handle = 0; handle < game->tileIds.size(); ++handle)
+    putString(game->tileIds.str(handle));
+  putUnsigned(game->unitIds.size());
+  for(Handle handle = 0; handle < game->unitIds.size(); ++handle)
+    putString(game->unitIds.str(handle));
+
+  Game::TileStore const& tiles = game->tiles;
+  putUnsigned(tiles.size());
+  for(Game::TileId tileId = 0; tileId < tiles.size(); ++tileId)
+  {
+    putSigned(tiles.x[tileId]);
+    putSigned(tiles.y[tileId]);
+    putSigned(tiles.type[tileId]);
+    putSigned(tiles.subtype[tileId]);
+    putSigned(tiles.owner[tileId]);
+    putHandle(tiles.unitId[tileId]);
+    putSigned(tiles.capturePoints[tileId]);
+    putUnsigned(tiles.beingCaptured[tileId]);
+  }
+
+  Game::UnitStore const& units = game->units;
+  putUnsigned(units.size());
+  for(Game::UnitId unitId = 0; unitId < units.size(); ++unitId)
+  {
+    putHandle(units.tileId[unitId]);
+    putSigned(units.type[unitId]);
+    putSigned(units.owner[unitId]);
+    putSigned(units.health[unitId]);
+    putHandle(units.carriedBy[unitId]);
+    putUnsigned(units.flags[unitId] | (units.moved(unitId) ? Game::UNIT_MOVED : 0));
+    putUnsigned(units.carriedUnits[unitId].size());
+    for(Game::UnitId carriedId : units.carriedUnits[unitId])
+      putHandle(carriedId);
+  }
+
+  putUnsigned(game->players.size());
+  for(auto const& item : game->players)
+  {
+    Game::Player const& player = item.second;
+    putString(player.id);
+    putString(player.userId);
+    putString(player.playerName);
+    putSigned(player.playerNumber);
+    putSigned(player.teamNumber);
+    putSigned(player.funds);
+    putSigned(player.score);
+    putUnsigned(player.emailNotifications | player.hidden << 1 | player.isMe << 2);
+  }
+
+  tileIdsWritten = game->tileIds.size();
+  unitIdsWritten = game->unitIds.size();
+}
+
+void wars::EventLog::writeIds()
+{
+  // Handles interned since the last record, e.g. the unit of a build event
+  for(; tileIdsWritten < game->tileIds.size(); ++tileIdsWritten)
+  {
+    buffer.push_back(static_cast<std::uint8_t>(RecordType::TILE_ID));
+    putString(game->tileIds.str(tileIdsWritten));
+  }
+  for(; unitIdsWritten < game->unitIds.size(); ++unitIdsWritten)
+  {
+    buffer.push_back(static_cast<std::uint8_t>(RecordType::UNIT_ID));
+    putString(game->unitIds.str(unitIdsWritten));
+  }
+}
+
+void wars::EventLog::flush()
+{
+  if(!file || flushed == buffer.size())
+    return;
+
+  if(std::fwrite(buffer.data() + flushed, 1, buffer.size() - flushed, file) != buffer.size() - flushed
+     || std::fflush(file) != 0)
+  {
+    throw std::runtime_error("Cannot write event log");
+  }
+  flushed = buffer.size();
+}
+
+void wars::EventLog::replay(Game& game) const
+{
+  if(buffer.size() < sizeof(MAGIC) || std::memcmp(buffer.data(), MAGIC, sizeof(MAGIC)) != 0)
+    throw std::runtime_error("Not an event log");
+
+  Reader reader(buffer, sizeof(MAGIC));
+  while(!reader.atEnd())
+  {
+    RecordType recordType = static_cast<RecordType>(reader.getByte());
+    switch(recordType)
+    {
+      case RecordType::SNAPSHOT:
+      {
+        // Decode fully before touching game in case the record is cut short
+        Snapshot snapshot;
+        readSnapshot(reader, snapshot);
+        if(!reader.good())
+          return;
+
+        game.gameId.swap(snapshot.gameId);
+        game.authorId.swap(snapshot.authorId);
+        game.name.swap(snapshot.name);
+        game.mapId.swap(snapshot.mapId);
+        game.state = snapshot.state;
+        game.turnStart = snapshot.turnStart;
+        game.turnNumber = snapshot.turnNumber;
+        game.roundNumber = snapshot.roundNumber;
+        game.inTurnNumber = snapshot.inTurnNumber;
+        game.publicGame = snapshot.publicGame;
+        game.turnLength = snapshot.turnLength;
+        game.bannedUnits.swap(snapshot.bannedUnits);
+
+        game.tileIds.clear();
+        for(std::string const& id : snapshot.tileIds)
+          game.tileIds.intern(id);
+        game.unitIds.clear();
+        for(std::string const& id : snapshot.unitIds)
+          game.unitIds.intern(id);
+
+        std::swap(game.tiles, snapshot.tiles);
+        std::swap(game.units, snapshot.units);
+        game.players.swap(snapshot.players);
+
+        game.movementOptionsCache.clear();
+        game.distanceFields.clear();
+        game.journalEntries.clear();
+        game.journalCarriedUnitLists.clear();
+        game.journalMarks.clear();
+        game.eventDepth = 0;
+        game.buildGridIndex();
+        game.buildAdjacency();
+        game.buildIndexes();
+
+        Game::Event event;
+        event.type = Game::EventType::GAMEDATA;
+        game.eventStream.push(event);
+
+        game.touchAll();
+        game.changed();
+        break;
+      }
+      case RecordType::TILE_ID:
+      case RecordType::UNIT_ID:
+      {
+        std::string id = reader.getString();
+        if(!reader.good())
+          return;
+
+        if(recordType == RecordType::TILE_ID)
+          game.tileIds.intern(id);
+        else
+          game.unitIds.intern(id);
+        break;
+      }
+      case RecordType::EVENT:
+      {
+        Game::EventType eventType = static_cast<Game::EventType>(reader.getByte());
+        switch(eventType)
+        {
+          case Game::EventType::MOVE:
+          {
+            Game::UnitId unitId = reader.getHandle();
+            Game::TileId tileId = reader.getHandle();
+            Game::Path path(reader.good() ? std::min<std::uint64_t>(reader.getUnsigned(), buffer.size()) : 0);
+            for(Game::Coordinates& pos : path)
+            {
+              pos.x = reader.getSigned();
+              pos.y = reader.getSigned();
+            }
+            if(reader.good())
+              game.moveUnit(unitId, tileId, path);
+            break;
+          }
+          case Game::EventType::WAIT:
+          {
+            Game::UnitId unitId = reader.getHandle();
+            if(reader.good())
+              game.waitUnit(unitId);
+            break;
+          }
+          case Game::EventType::ATTACK:
+          case Game::EventType::COUNTERATTACK:
+          {
+            Game::UnitId attackerId = reader.getHandle();
+            Game::UnitId targetId = reader.getHandle();
+            int damage = reader.getSigned();
+            if(!reader.good())
+              break;
+            if(eventType == Game::EventType::ATTACK)
+              game.attackUnit(attackerId, targetId, damage);
+            else
+              game.counterattackUnit(attackerId, targetId, damage);
+            break;
+          }
+          case Game::EventType::CAPTURE:
+          {
+            Game::UnitId unitId = reader.getHandle();
+            Game::TileId tileId = reader.getHandle();
+            int left = reader.getSigned();
+            if(reader.good())
+              game.captureTile(unitId, tileId, left);
+            break;
+          }
+          case Game::EventType::CAPTURED:
+          {
+            Game::UnitId unitId = reader.getHandle();
+            Game::TileId tileId = reader.getHandle();
+            if(reader.good())
+              game.capturedTile(unitId, tileId);
+            break;
+          }
+          case Game::EventType::DEPLOY:
+          case Game::EventType::UNDEPLOY:
+          case Game::EventType::DESTROY:
+          {
+            Game::UnitId unitId = reader.getHandle();
+            if(!reader.good())
+              break;
+            if(eventType == Game::EventType::DEPLOY)
+              game.deployUnit(unitId);
+            else if(eventType == Game::EventType::UNDEPLOY)
+              game.undeployUnit(unitId);
+            else
+              game.destroyUnit(unitId);
+            break;
+          }
+          case Game::EventType::LOAD:
+          {
+            Game::UnitId unitId = reader.getHandle();
+            Game::UnitId carrierId = reader.getHandle();
+            if(reader.good())
+              game.loadUnit(unitId, carrierId);
+            break;
+          }
+          case Game::EventType::UNLOAD:
+          {
+            Game::UnitId unitId = reader.getHandle();
+            Game::UnitId carrierId = reader.getHandle();
+            Game::TileId tileId = reader.getHandle();
+            if(reader.good())
+              game.unloadUnit(unitId, carrierId, tileId);
+            break;
+          }
+          case Game::EventType::REPAIR:
+          {
+            Game::UnitId unitId = reader.getHandle();
+            int newHealth = reader.getSigned();
+            if(reader.good())
+              game.repairUnit(unitId, newHealth);
+            break;
+          }
+          case Game::EventType::BUILD:
+          {
+            Game::TileId tileId = reader.getHandle();
+            Game::UnitId unitId = reader.getHandle();
+            int unitType = reader.getSigned();
+            int owner = reader.getSigned();
+            int health = reader.getSigned();
+            if(!reader.good())
+              break;
+
+            // Same as updateUnitFromJSON for a new unit
+            Game::UnitStore& units = game.units;
+            if(unitId >= units.size())
+              units.resize(unitId + 1);
+            if(unitId < game.movementOptionsCache.size())
+              game.movementOptionsCache[unitId].valid = false;
+            units.tileId[unitId] = tileId;
+            units.type[unitId] = unitType;
+            units.owner[unitId] = owner;
+            units.health[unitId] = health;
+            units.carriedBy[unitId] = Game::NO_UNIT;
+            units.flags[unitId] = Game::UNIT_ALIVE;
+            units.carriedUnits[unitId].clear();
+            game.buildUnit(tileId, unitId);
+            break;
+          }
+          case Game::EventType::REGENERATE_CAPTURE_POINTS:
+          {
+            Game::TileId tileId = reader.getHandle();
+            int newCapturePoints = reader.getSigned();
+            if(reader.good())
+              game.regenerateCapturePointsTile(tileId, newCapturePoints);
+            break;
+          }
+          case Game::EventType::PRODUCE_FUNDS:
+          {
+            Game::TileId tileId = reader.getHandle();
+            if(reader.good())
+              game.produceFundsTile(tileId);
+            break;
+          }
+          case Game::EventType::BEGIN_TURN:
+          case Game::EventType::END_TURN:
+          case Game::EventType::TURN_TIMEOUT:
+          case Game::EventType::FINISHED:
+          case Game::EventType::SURRENDER:
+          {
+            int playerNumber = reader.getSigned();
+            if(!reader.good())
+              break;
+            if(eventType == Game::EventType::BEGIN_TURN)
+              game.beginTurn(playerNumber);
+            else if(eventType == Game::EventType::END_TURN)
+              game.endTurn(playerNumber);
+            else if(eventType == Game::EventType::TURN_TIMEOUT)
+              game.turnTimeout(playerNumber);
+            else if(eventType == Game::EventType::FINISHED)
+              game.finished(playerNumber);
+            else
+              game.surrender(playerNumber);
+            break;
+          }
+          case Game::EventType::ROLLBACK:
+          {
+            // Decoded into journal entries and reverted like a rollback, so
+            // indexes, caches and subscribers see the same changes
+            typedef Game::JournalField Field;
+            std::vector<Game::JournalEntry> entries;
+            std::vector<std::vector<Game::UnitId>> carriedUnitLists;
+            entries.push_back({Field::STATE, 0, static_cast<std::int64_t>(reader.getUnsigned())});
+            entries.push_back({Field::IN_TURN_NUMBER, 0, reader.getSigned()});
+
+            for(std::uint64_t i = reader.getUnsigned(); i > 0 && reader.good(); --i)
+            {
+              Game::TileId tileId = reader.getHandle();
+              entries.push_back({Field::TILE_OWNER, tileId, reader.getSigned()});
+              entries.push_back({Field::TILE_UNIT, tileId, reader.getHandle()});
+              entries.push_back({Field::TILE_CAPTURE_POINTS, tileId, reader.getSigned()});
+              entries.push_back({Field::TILE_BEING_CAPTURED, tileId, static_cast<std::int64_t>(reader.getUnsigned())});
+            }
+
+            for(std::uint64_t i = reader.good() ? reader.getUnsigned() : 0; i > 0 && reader.good(); --i)
+            {
+              Game::UnitId unitId = reader.getHandle();
+              entries.push_back({Field::UNIT_TILE, unitId, reader.getHandle()});
+              entries.push_back({Field::UNIT_TYPE, unitId, reader.getSigned()});
+              entries.push_back({Field::UNIT_OWNER, unitId, reader.getSigned()});
+              entries.push_back({Field::UNIT_HEALTH, unitId, reader.getSigned()});
+              entries.push_back({Field::UNIT_CARRIED_BY, unitId, reader.getHandle()});
+              unsigned int flags = reader.getUnsigned();
+              entries.push_back({Field::UNIT_FLAGS, unitId, flags & ~Game::UNIT_MOVED});
+              entries.push_back({Field::UNIT_MOVED_TURN, unitId, flags & Game::UNIT_MOVED ? game.units.turnGeneration : 0});
+              entries.push_back({Field::UNIT_CARRIED_UNITS, unitId, 0});
+              carriedUnitLists.emplace_back();
+              for(std::uint64_t j = reader.getUnsigned(); j > 0 && reader.good(); --j)
+                carriedUnitLists.back().push_back(reader.getHandle());
+            }
+            if(!reader.good())
+              break;
+
+            for(Game::JournalEntry const& entry : entries)
+            {
+              if((entry.field <= Field::TILE_BEING_CAPTURED && entry.index >= game.tiles.size())
+                 || (entry.field >= Field::UNIT_TILE && entry.field <= Field::UNIT_CARRIED_UNITS
+                     && entry.index >= game.units.size()))
+                throw std::runtime_error("Unknown tile or unit in event log");
+            }
+
+            // Entries are reverted from the back and each carried unit list
+            // is taken from the back as its entry is reached
+            std::size_t position = game.journalEntries.size();
+            game.journalEntries.insert(game.journalEntries.end(), entries.begin(), entries.end());
+            for(std::vector<Game::UnitId>& carriedUnits : carriedUnitLists)
+              game.journalCarriedUnitLists.push_back(std::move(carriedUnits));
+            game.revertJournal(position);
+            break;
+          }
+          default:
+            if(reader.good())
+              throw std::runtime_error("Unknown event type in event log");
+        }
+
+        if(!reader.good())
+          return;
+        break;
+      }
+      default:
+        throw std::runtime_error("Unknown record in event log");
+    }
+  }
+}
+
+void wars::EventLog::putUnsigned(std::uint64_t value)
+{
+  while(value >= 0x80)
+  {
+    buffer.push_back(static_cast<std::uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<std::uint8_t>(value));
+}
+
+void wars::EventLog::putSigned(std::int64_t value)
+{
+  // Zigzag keeps small negative numbers short
+  putUnsigned((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+void wars::EventLog::putHandle(Handle handle)
+{
+  // INVALID_HANDLE wraps around to 0
+  putUnsigned(static_cast<Handle>(handle + 1));
+}
+
+void wars::EventLog::putDouble(double value)
+{
+  std::uint8_t bytes[sizeof(double)];
+  std::memcpy(bytes, &value, sizeof(double));
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(double));
+}
+
+void wars::EventLog::putString(std::string const& value)
+{
+  putUnsigned(value.size());
+  buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+namespace
+{
+  std::uint8_t Reader::getByte()
+  {
+    if(pos >= data.size())
+    {
+      ok = false;
+      return 0;
+    }
+    return data[pos++];
+  }
+
+  std::uint64_t Reader::getUnsigned()
+  {
+    std::uint64_t value = 0;
+    for(int shift = 0; shift < 64; shift += 7)
+    {
+      std::uint8_t byte = getByte();
+      value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      if(!(byte & 0x80))
+        break;
+    }
+    return value;
+  }
+
+  std::int64_t Reader::getSigned()
+  {
+    std::uint64_t value = getUnsigned();
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+  }
+
+  wars::Handle Reader::getHandle()
+  {
+    return static_cast<wars::Handle>(getUnsigned() - 1);
+  }
+
+  double Reader::getDouble()
+  {
+    double value = 0;
+    if(data.size() - pos < sizeof(double))
+    {
+      ok = false;
+      pos = data.size();
+      return value;
+    }
+    std::memcpy(&value, data.data() + pos, sizeof(double));
+    pos += sizeof(double);
+    return value;
+  }
+
+  std::string Reader::getString()
+  {
+    std::uint64_t size = getUnsigned();
+    if(!ok || data.size() - pos < size)
+    {
+      ok = false;
+      pos = data.size();
+      return std::string();
+    }
+    std::string value(data.begin() + pos, data.begin() + pos + size);
+    pos += size;
+    return value;
+  }
+
+  void readSnapshot(Reader& reader, Snapshot& snapshot)
+  {
+    snapshot.gameId = reader.getString();
+    snapshot.authorId = reader.getString();
+    snapshot.name = reader.getString();
+    snapshot.mapId = reader.getString();
+    snapshot.state = static_cast<wars::Game::State>(reader.getUnsigned());
+    snapshot.turnStart = reader.getDouble();
+    snapshot.turnNumber = reader.getSigned();
+    snapshot.roundNumber = reader.getSigned();
+    snapshot.inTurnNumber = reader.getSigned();
+    snapshot.publicGame = reader.getUnsigned();
+    snapshot.turnLength = reader.getDouble();
+    for(std::uint64_t i = reader.getUnsigned(); i > 0 && reader.good(); --i)
+      snapshot.bannedUnits.insert(reader.getSigned());
+
+    for(std::uint64_t i = reader.getUnsigned(); i > 0 && reader.good(); --i)
+      snapshot.tileIds.push_back(reader.getString());
+    for(std::uint64_t i = reader.getUnsigned(); i > 0 && reader.good(); --i)
+      snapshot.unitIds.push_back(reader.getString());
+
+    // Counts are capped so that a corrupt one cannot exhaust memory, the
+    // reader runs out of data first
+    std::uint64_t const numTiles = reader.good() ? reader.getUnsigned() : 0;
+    wars::Game::TileStore& tiles = snapshot.tiles;
+    tiles.resize(std::min<std::uint64_t>(numTiles, 1 << 24));
+    for(wars::Game::TileId tileId = 0; tileId < tiles.size() && reader.good(); ++tileId)
+    {
+      tiles.x[tileId] = reader.getSigned();
+      tiles.y[tileId] = reader.getSigned();
+      tiles.type[tileId] = reader.getSigned();
+      tiles.subtype[tileId] = reader.getSigned();
+      tiles.owner[tileId] = reader.getSigned();
+      tiles.unitId[tileId] = reader.getHandle();
+      tiles.capturePoints[tileId] = reader.getSigned();
+      tiles.beingCaptured[tileId] = reader.getUnsigned();
+    }
+
+    std::uint64_t const numUnits = reader.good() ? reader.getUnsigned() : 0;
+    wars::Game::UnitStore& units = snapshot.units;
+    units.resize(std::min<std::uint64_t>(numUnits, 1 << 24));
+    for(wars::Game::UnitId unitId = 0; unitId < units.size() && reader.good(); ++unitId)
+    {
+      units.tileId[unitId] = reader.getHandle();
+      units.type[unitId] = reader.getSigned();
+      units.owner[unitId] = reader.getSigned();
+      units.health[unitId] = reader.getSigned();
+      units.carriedBy[unitId] = reader.getHandle();
+      units.flags[unitId] = reader.getUnsigned();
+      units.movedTurn[unitId] = units.flags[unitId] & wars::Game::UNIT_MOVED ? units.turnGeneration : 0;
+      units.flags[unitId] &= ~wars::Game::UNIT_MOVED;
+      for(std::uint64_t i = reader.getUnsigned(); i > 0 && reader.good(); --i)
+        units.carriedUnits[unitId].push_back(reader.getHandle());
+    }
+
+    for(std::uint64_t i = reader.good() ? reader.getUnsigned() : 0; i > 0 && reader.good(); --i)
+    {
+      wars::Game::Player player;
+      player.id = reader.getString();
+      player.userId = reader.getString();
+      player.playerName = reader.getString();
+      player.playerNumber = reader.getSigned();
+      player.teamNumber = reader.getSigned();
+      player.funds = reader.getSigned();
+      player.score = reader.getSigned();
+      unsigned int flags = reader.getUnsigned();
+      player.emailNotifications = flags & 1;
+      player.hidden = flags & 2;
+      player.isMe = flags & 4;
+      snapshot.players[player.playerNumber] = player;
+    }
+  }
+}
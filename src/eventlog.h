@@ -0,0 +1,68 @@
+#ifndef WARS_EVENTLOG_H
+#define WARS_EVENTLOG_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+#include "game.h"
+
+namespace wars
+{
+  // Append-only binary log of a game. Starts with a snapshot of the game
+  // state and continues with one record per event, integers are varints and
+  // IDs are handles with their strings logged when first seen. Rules are not
+  // logged, the replaying game needs them loaded already.
+  class EventLog
+  {
+  public:
+    EventLog();
+    ~EventLog();
+
+    EventLog(EventLog const&) = delete;
+    EventLog& operator=(EventLog const&) = delete;
+
+    // Replaces the log with the contents of the file at path, throws
+    // std::runtime_error if it cannot be read or is not an event log
+    void load(std::string const& path);
+    // Writes the log to the file at path and appends each later record to it,
+    // throws std::runtime_error if it cannot be written
+    void open(std::string const& path);
+    void close();
+
+    // Logs a snapshot of game if it has state, then every event of game until stop
+    void record(Game& game);
+    void stop();
+
+    std::vector<std::uint8_t> const& data() const;
+
+    // Applies the log to game through its event handlers. A truncated last
+    // record, as left by a crash, is skipped.
+    void replay(Game& game) const;
+
+  private:
+    enum class RecordType : std::uint8_t { SNAPSHOT, TILE_ID, UNIT_ID, EVENT };
+
+    void handleEvent(Game::Event const& event);
+    void writeSnapshot();
+    void writeIds();
+    void flush();
+
+    void putUnsigned(std::uint64_t value);
+    void putSigned(std::int64_t value);
+    void putHandle(Handle handle);
+    void putDouble(double value);
+    void putString(std::string const& value);
+
+    Game* game;
+    Stream<Game::Event>::Subscription eventSub;
+    std::vector<std::uint8_t> buffer;
+    std::FILE* file;
+    std::size_t flushed;
+    std::size_t tileIdsWritten;
+    std::size_t unitIdsWritten;
+  };
+}
+
+#endif // WARS_EVENTLOG_H
@@ -3,10 +3,77 @@
 #include <sstream>
 #include <algorithm>
 #include <queue>
+#include <stdexcept>
 #include <cmath>
 #include <map>
+#include <utility>
 
 #include "jsonpp.h"
+#include "eventlog.h"
+
+// Path cost policies for AStar
+class wars::Game::UniformCost
+{
+public:
+  UniformCost(Game const& game, Coordinates const& goal) : game(game), goal(goal)
+  {
+  }
+
+  int cost(TileId) const
+  {
+    return 1;
+  }
+
+  int maxCost() const
+  {
+    return -1;
+  }
+
+  int heuristic(TileId tileId) const
+  {
+    return Topology::distance(goal.x - game.tiles.x[tileId], goal.y - game.tiles.y[tileId]);
+  }
+
+private:
+  Game const& game;
+  Coordinates goal;
+};
+
+class wars::Game::UnitMovementCost
+{
+public:
+  UnitMovementCost(Game const& game, UnitId unitId, Coordinates const& goal) :
+    game(game), goal(goal), owner(game.units.owner.at(unitId)),
+    movementType(game.ruleTables.movementType(game.units.type.at(unitId))),
+    movement(game.ruleTables.movement(game.units.type[unitId])),
+    // Distance times the cheapest step keeps the heuristic admissible
+    minCost(game.ruleTables.minMovementCost(movementType))
+  {
+  }
+
+  int cost(TileId tileId) const
+  {
+    return game.movementCost(movementType, owner, tileId);
+  }
+
+  int maxCost() const
+  {
+    return movement;
+  }
+
+  int heuristic(TileId tileId) const
+  {
+    return minCost * Topology::distance(goal.x - game.tiles.x[tileId], goal.y - game.tiles.y[tileId]);
+  }
+
+private:
+  Game const& game;
+  Coordinates goal;
+  int owner;
+  int movementType;
+  int movement;
+  int minCost;
+};
 
 std::unordered_map<std::string, wars::Game::State> const wars::Game::STATE_NAMES = {
   {"pregame", State::PREGAME},
@@ -14,8 +81,34 @@ std::unordered_map<std::string, wars::Game::State> const wars::Game::STATE_NAMES
   {"finished", State::FINISHED}
 };
 
+wars::Game::TileId const wars::Game::NO_TILE;
+wars::Game::UnitId const wars::Game::NO_UNIT;
+
 namespace
 {
+  // Server action names indexed by EventType, GAMEDATA has no action
+  char const* const ACTION_NAMES[] = {
+    "", "move", "wait", "attack", "counterattack", "capture", "captured",
+    "deploy", "undeploy", "load", "unload", "destroyed", "repair", "build",
+    "regenerateCapturePoints", "produceFunds", "beginTurn",
+    "endTurn", "turnTimeout", "finished", "surrender"
+  };
+
+  // FNV-1a, constexpr so that action names can be case labels. Two names
+  // with the same hash fail to compile as duplicate case labels.
+  constexpr std::uint32_t actionHash(char const* name, std::uint32_t hash = 2166136261u)
+  {
+    return *name ? actionHash(name + 1, (hash ^ static_cast<unsigned char>(*name)) * 16777619u) : hash;
+  }
+
+  std::uint32_t actionHash(std::string const& name)
+  {
+    std::uint32_t hash = 2166136261u;
+    for(char c : name)
+      hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    return hash;
+  }
+
   template<typename T>
   T parse(json::Value const& v);
 
@@ -46,12 +139,21 @@ namespace
   std::unordered_set<int> parseIntSet(json::Value const& v);
   int parseIntOrNull(json::Value const& v, int nullValue);
   std::string parseStringOrNull(json::Value const& v, std::string const& nullValue);
+  wars::Handle parseHandleOrNull(json::Value const& v, wars::IdTable& ids, wars::Handle nullValue);
   wars::Game::Path parsePath(json::Value const& v);
+  void setFlag(std::uint8_t& flags, std::uint8_t flag, bool value);
+  std::uint64_t mortonIndex(std::uint32_t x, std::uint32_t y);
+  std::uint64_t hilbertIndex(std::uint32_t size, std::uint32_t x, std::uint32_t y);
 }
 wars::Game::Game(): gameId(), authorId(),  name(), mapId(),
   state(State::PREGAME), turnStart(0), turnNumber(0), roundNumber(0), inTurnNumber(0),
   publicGame(false), turnLength(0), bannedUnits(0),
-  rules(), tiles(), units(),  players(), eventStream()
+  tileLayout(TileLayout::MORTON), rules(), tiles(), units(),  players(),
+  gridMinX(0), gridMinY(0), gridWidth(0), gridHeight(0), tileGrid(), unitGrid(),
+  unitsByOwner(), tilesByOwner(), tilesByType(), allianceMasks(),
+  occupiedBoard(), ownerBoards(), passableBoards(), emptyBoard(),
+  distanceFieldUses(0), journalEntries(), journalCarriedUnitLists(), journalMarks(), revertedTileIds(), revertedUnitIds(),
+  pendingChanges(), tileTouched(), unitTouched(), batchDepth(0), eventDepth(0), eventStream(), changeStream()
 {
 
 }
@@ -66,9 +168,54 @@ Stream<wars::Game::Event> wars::Game::events()
   return eventStream;
 }
 
+Stream<wars::Game::ChangeSet> wars::Game::changes()
+{
+  return changeStream;
+}
+
+template<typename T>
+void wars::Game::setField(JournalField field, std::vector<T>& column, std::uint32_t index,
+                          typename std::vector<T>::value_type value)
+{
+  T& current = column.at(index);
+  journal(field, index, current);
+  current = value;
+
+  if(field <= JournalField::TILE_BEING_CAPTURED)
+    touchTile(index);
+  else if(field <= JournalField::UNIT_CARRIED_UNITS)
+    touchUnit(index);
+  indexField(field, index);
+}
+
 void wars::Game::setRulesFromJSON(const json::Value& value)
 {
-  rules = parse<Rules>(value);
+  // Rules naming unknown weapons throw before anything is replaced
+  Rules parsed = parse<Rules>(value);
+  ruleTables.compile(parsed);
+  rules = std::move(parsed);
+  damageTable.compile(rules);
+  buildPassableBoards();
+
+  // Cached movement and distances used the old costs
+  movementOptionsCache.clear();
+  distanceFields.clear();
+
+  // Game data loaded before the rules is seen anew, like after a snapshot
+  if(tiles.size() > 0)
+  {
+    Event event;
+    event.type = EventType::GAMEDATA;
+    eventStream.push(event);
+
+    touchAll();
+    changed();
+  }
+}
+
+void wars::Game::setTileLayout(TileLayout layout)
+{
+  tileLayout = layout;
 }
 
 void wars::Game::setGameDataFromJSON(const json::Value& value)
@@ -89,13 +236,66 @@ void wars::Game::setGameDataFromJSON(const json::Value& value)
   turnLength = parseIntOrNull(settings.get("turnLength"), -1);
   bannedUnits = parseIntSet(settings.get("bannedUnits"));
 
+  tileIds.clear();
+  unitIds.clear();
+  tiles.clear();
+  units.clear();
+  unitsByOwner.clear();
+  tilesByOwner.clear();
+  tilesByType.clear();
+  movementOptionsCache.clear();
+  distanceFields.clear();
+  journalEntries.clear();
+  journalCarriedUnitLists.clear();
+  journalMarks.clear();
+  eventDepth = 0;
+
+  // TileIds are handed out in load order, so loading along the curve lays
+  // the tile columns out along it
   json::Value tileArray = game.get("tiles");
   unsigned int numTiles = tileArray.size();
-  for(unsigned int i = 0; i < numTiles; ++i)
+  std::vector<std::pair<std::uint64_t, unsigned int>> loadOrder(numTiles); // curve index, array index
+  if(tileLayout != TileLayout::RECEIVED && numTiles > 0)
+  {
+    std::vector<int> xs(numTiles);
+    std::vector<int> ys(numTiles);
+    for(unsigned int i = 0; i < numTiles; ++i)
+    {
+      json::Value tile = tileArray.at(i);
+      xs[i] = tile.get("x").longValue();
+      ys[i] = tile.get("y").longValue();
+    }
+
+    int minX = *std::min_element(xs.begin(), xs.end());
+    int minY = *std::min_element(ys.begin(), ys.end());
+    std::uint32_t extent = std::max(*std::max_element(xs.begin(), xs.end()) - minX,
+                                    *std::max_element(ys.begin(), ys.end()) - minY) + 1;
+    std::uint32_t size = 1;
+    while(size < extent)
+      size <<= 1;
+
+    for(unsigned int i = 0; i < numTiles; ++i)
+    {
+      std::uint32_t x = xs[i] - minX;
+      std::uint32_t y = ys[i] - minY;
+      loadOrder[i].first = tileLayout == TileLayout::MORTON ? mortonIndex(x, y) : hilbertIndex(size, x, y);
+      loadOrder[i].second = i;
+    }
+    std::sort(loadOrder.begin(), loadOrder.end());
+  }
+  else
+  {
+    for(unsigned int i = 0; i < numTiles; ++i)
+      loadOrder[i] = std::make_pair(0, i);
+  }
+
+  for(auto const& item : loadOrder)
   {
-    json::Value tile = tileArray.at(i);
+    json::Value tile = tileArray.at(item.second);
     updateTileFromJSON(tile);
   }
+  buildGridIndex();
+  buildAdjacency();
 
   json::Value playerArray = game.get("players");
   unsigned int numPlayers = playerArray.size();
@@ -104,354 +304,489 @@ void wars::Game::setGameDataFromJSON(const json::Value& value)
     json::Value player = playerArray.at(i);
     updatePlayerFromJSON(player);
   }
+  buildIndexes();
 
   Event event;
   event.type = EventType::GAMEDATA;
   eventStream.push(event);
+
+  touchAll();
+
+  changed();
 }
 
 void wars::Game::processEventFromJSON(const json::Value& value)
 {
   json::Value content = value.get("content");
-  std::string action = content.get("action").stringValue();
-
-  if(action == "move")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    std::string tileId = content.get("tile").get("tileId").stringValue();
-    Path path = parsePath(content.get("path"));
-    moveUnit(unitId, tileId, path);
-  }
-  else if(action == "wait")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    waitUnit(unitId);
-  }
-  else if(action == "attack")
+  std::string const action = content.get("action").stringValue();
+
+  // Perfect hash of the action name, a match is confirmed by comparing names
+  EventType type;
+  switch(actionHash(action))
+  {
+    case actionHash("move"): type = EventType::MOVE; break;
+    case actionHash("wait"): type = EventType::WAIT; break;
+    case actionHash("attack"): type = EventType::ATTACK; break;
+    case actionHash("counterattack"): type = EventType::COUNTERATTACK; break;
+    case actionHash("capture"): type = EventType::CAPTURE; break;
+    case actionHash("captured"): type = EventType::CAPTURED; break;
+    case actionHash("deploy"): type = EventType::DEPLOY; break;
+    case actionHash("undeploy"): type = EventType::UNDEPLOY; break;
+    case actionHash("load"): type = EventType::LOAD; break;
+    case actionHash("unload"): type = EventType::UNLOAD; break;
+    case actionHash("destroyed"): type = EventType::DESTROY; break;
+    case actionHash("repair"): type = EventType::REPAIR; break;
+    case actionHash("build"): type = EventType::BUILD; break;
+    case actionHash("regenerateCapturePoints"): type = EventType::REGENERATE_CAPTURE_POINTS; break;
+    case actionHash("produceFunds"): type = EventType::PRODUCE_FUNDS; break;
+    case actionHash("beginTurn"): type = EventType::BEGIN_TURN; break;
+    case actionHash("endTurn"): type = EventType::END_TURN; break;
+    case actionHash("turnTimeout"): type = EventType::TURN_TIMEOUT; break;
+    case actionHash("finished"): type = EventType::FINISHED; break;
+    case actionHash("surrender"): type = EventType::SURRENDER; break;
+    default:
+      std::cerr << "Unknown event action: " << action << std::endl;
+      return;
+  }
+
+  if(action != ACTION_NAMES[static_cast<int>(type)])
   {
-    std::string attackerId = content.get("attacker").get("unitId").stringValue();
-    std::string targetId = content.get("target").get("unitId").stringValue();
-    int damage = content.get("damage").longValue();
-    attackUnit(attackerId, targetId, damage);
+    std::cerr << "Unknown event action: " << action << std::endl;
+    return;
   }
-  else if(action == "counterattack")
+
+  switch(type)
   {
-    std::string attackerId = content.get("attacker").get("unitId").stringValue();
-    std::string targetId = content.get("target").get("unitId").stringValue();
-    int damage = -1;
-    if(content.get("damage").type() == json::Value::Type::NUMBER)
+    case EventType::MOVE:
     {
-      damage = content.get("damage").longValue();
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      TileId tileId = tileIds.intern(content.get("tile").get("tileId").stringValue());
+      Path path = parsePath(content.get("path"));
+      moveUnit(unitId, tileId, path);
+      break;
     }
-    counterattackUnit(attackerId, targetId, damage);
-  }
-  else if(action == "capture")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    std::string tileId = content.get("tile").get("tileId").stringValue();
-    int left = content.get("left").longValue();
-    captureTile(unitId, tileId, left);
-  }
-  else if(action == "captured")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    std::string tileId = content.get("tile").get("tileId").stringValue();
-    capturedTile(unitId, tileId);
-  }
-  else if(action == "deploy")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    deployUnit(unitId);
-  }
-  else if(action == "undeploy")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    undeployUnit(unitId);
-  }
-  else if(action == "load")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    std::string carrierId = content.get("carrier").get("unitId").stringValue();
-    loadUnit(unitId, carrierId);
-  }
-  else if(action == "unload")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    std::string carrierId = content.get("carrier").get("unitId").stringValue();
-    std::string tileId = content.get("tile").get("tileId").stringValue();
-    unloadUnit(unitId, carrierId, tileId);
-  }
-  else if(action == "destroyed")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    destroyUnit(unitId);
-  }
-  else if(action == "repair")
-  {
-    std::string unitId = content.get("unit").get("unitId").stringValue();
-    int newHealth = content.get("newHealth").longValue();
-    repairUnit(unitId, newHealth);
-  }
-  else if(action == "build")
-  {
-    std::string tileId = content.get("tile").get("tileId").stringValue();
-    std::string unitId = updateUnitFromJSON(content.get("unit"));
-    units[unitId].tileId = tileId;
-    buildUnit(tileId, unitId);
-  }
-  else if(action == "regenerateCapturePoints")
-  {
-    std::string tileId = content.get("tile").get("tileId").stringValue();
-    int newCapturePoints = content.get("newCapturePoints").longValue();
-    regenerateCapturePointsTile(tileId, newCapturePoints);
-  }
-  else if(action == "produceFunds")
-  {
-    std::string tileId = content.get("tile").get("tileId").stringValue();
-    produceFundsTile(tileId);
-  }
-  else if(action == "beginTurn")
-  {
-    int playerNumber = content.get("player").longValue();
-    beginTurn(playerNumber);
-  }
-  else if(action == "endTurn")
-  {
-    int playerNumber = content.get("player").longValue();
-    endTurn(playerNumber);
-  }
-  else if(action == "turnTimeout")
-  {
-    int playerNumber = content.get("player").longValue();
-    turnTimeout(playerNumber);
-  }
-  else if(action == "finished")
-  {
-    int winnerPlayerNumber = content.get("winner").longValue();
-    finished(winnerPlayerNumber);
+    case EventType::WAIT:
+    {
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      waitUnit(unitId);
+      break;
+    }
+    case EventType::ATTACK:
+    {
+      UnitId attackerId = unitIds.intern(content.get("attacker").get("unitId").stringValue());
+      UnitId targetId = unitIds.intern(content.get("target").get("unitId").stringValue());
+      int damage = content.get("damage").longValue();
+      attackUnit(attackerId, targetId, damage);
+      break;
+    }
+    case EventType::COUNTERATTACK:
+    {
+      UnitId attackerId = unitIds.intern(content.get("attacker").get("unitId").stringValue());
+      UnitId targetId = unitIds.intern(content.get("target").get("unitId").stringValue());
+      int damage = -1;
+      if(content.get("damage").type() == json::Value::Type::NUMBER)
+      {
+        damage = content.get("damage").longValue();
+      }
+      counterattackUnit(attackerId, targetId, damage);
+      break;
+    }
+    case EventType::CAPTURE:
+    {
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      TileId tileId = tileIds.intern(content.get("tile").get("tileId").stringValue());
+      int left = content.get("left").longValue();
+      captureTile(unitId, tileId, left);
+      break;
+    }
+    case EventType::CAPTURED:
+    {
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      TileId tileId = tileIds.intern(content.get("tile").get("tileId").stringValue());
+      capturedTile(unitId, tileId);
+      break;
+    }
+    case EventType::DEPLOY:
+    {
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      deployUnit(unitId);
+      break;
+    }
+    case EventType::UNDEPLOY:
+    {
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      undeployUnit(unitId);
+      break;
+    }
+    case EventType::LOAD:
+    {
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      UnitId carrierId = unitIds.intern(content.get("carrier").get("unitId").stringValue());
+      loadUnit(unitId, carrierId);
+      break;
+    }
+    case EventType::UNLOAD:
+    {
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      UnitId carrierId = unitIds.intern(content.get("carrier").get("unitId").stringValue());
+      TileId tileId = tileIds.intern(content.get("tile").get("tileId").stringValue());
+      unloadUnit(unitId, carrierId, tileId);
+      break;
+    }
+    case EventType::DESTROY:
+    {
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      destroyUnit(unitId);
+      break;
+    }
+    case EventType::REPAIR:
+    {
+      UnitId unitId = unitIds.intern(content.get("unit").get("unitId").stringValue());
+      int newHealth = content.get("newHealth").longValue();
+      repairUnit(unitId, newHealth);
+      break;
+    }
+    case EventType::BUILD:
+    {
+      TileId tileId = tileIds.intern(content.get("tile").get("tileId").stringValue());
+      UnitId unitId = updateUnitFromJSON(content.get("unit"));
+      setField(JournalField::UNIT_TILE, units.tileId, unitId, tileId);
+      buildUnit(tileId, unitId);
+      break;
+    }
+    case EventType::REGENERATE_CAPTURE_POINTS:
+    {
+      TileId tileId = tileIds.intern(content.get("tile").get("tileId").stringValue());
+      int newCapturePoints = content.get("newCapturePoints").longValue();
+      regenerateCapturePointsTile(tileId, newCapturePoints);
+      break;
+    }
+    case EventType::PRODUCE_FUNDS:
+    {
+      TileId tileId = tileIds.intern(content.get("tile").get("tileId").stringValue());
+      produceFundsTile(tileId);
+      break;
+    }
+    case EventType::BEGIN_TURN:
+    {
+      int playerNumber = content.get("player").longValue();
+      beginTurn(playerNumber);
+      break;
+    }
+    case EventType::END_TURN:
+    {
+      int playerNumber = content.get("player").longValue();
+      endTurn(playerNumber);
+      break;
+    }
+    case EventType::TURN_TIMEOUT:
+    {
+      int playerNumber = content.get("player").longValue();
+      turnTimeout(playerNumber);
+      break;
+    }
+    case EventType::FINISHED:
+    {
+      int winnerPlayerNumber = content.get("winner").longValue();
+      finished(winnerPlayerNumber);
+      break;
+    }
+    case EventType::SURRENDER:
+    {
+      int playerNumber = content.get("player").longValue();
+      surrender(playerNumber);
+      break;
+    }
+    default:
+      break;
   }
-  else if(action == "surrender")
+}
+
+void wars::Game::processEventsFromJSON(const json::Value& value)
+{
+  beginBatch();
+  try
   {
-    int playerNumber = content.get("player").longValue();
-    surrender(playerNumber);
+    unsigned int numEvents = value.size();
+    for(int i = 0; i < numEvents; ++i)
+    {
+      json::Value event = value.at(i);
+      processEventFromJSON(event);
+    }
   }
-  else
+  catch(...)
   {
-    std::cerr << "Unknown event action: " << action << std::endl;
+    commitBatch();
+    throw;
   }
+  commitBatch();
 }
 
-void wars::Game::processEventsFromJSON(const json::Value& value)
+void wars::Game::replay(EventLog const& log)
 {
-  unsigned int numEvents = value.size();
-  for(int i = 0; i < numEvents; ++i)
-  {
-    json::Value event = value.at(i);
-    processEventFromJSON(event);
-  }
+  log.replay(*this);
 }
 
-void wars::Game::moveUnit(std::string const& unitId, std::string const& tileId, Path const& path)
+void wars::Game::moveUnit(UnitId unitId, TileId tileId, Path const& path)
 {
   Event event;
   event.type = EventType::MOVE;
-  event.move.unitId = &unitId;
-  event.move.tileId = &tileId;
+  event.move.unitId = unitId;
+  event.move.tileId = tileId;
   event.move.path = &path;
   eventStream.push(event);
 
-  Unit& unit = units.at(unitId);
-  Tile& tile = tiles.at(tileId);
-  tiles.at(unit.tileId).unitId.clear();
-  if(tile.unitId.empty())
-    tile.unitId = unitId;
-  unit.tileId = tileId;
+  TileId unitTileId = units.tileId.at(unitId);
+  occupancyChanged(unitTileId);
+  occupancyChanged(tileId);
+  setTileUnit(unitTileId, NO_UNIT);
+  if(tiles.unitId.at(tileId) == NO_UNIT)
+    setTileUnit(tileId, unitId);
+  setField(JournalField::UNIT_TILE, units.tileId, unitId, tileId);
+
+  changed();
 }
 
-void wars::Game::waitUnit(std::string const& unitId)
+void wars::Game::waitUnit(UnitId unitId)
 {
   Event event;
   event.type = EventType::WAIT;
-  event.wait.unitId = &unitId;
+  event.wait.unitId = unitId;
   eventStream.push(event);
 
-  units.at(unitId).moved = true;
+  setMoved(unitId);
+
+  changed();
 }
 
-void wars::Game::attackUnit(std::string const& attackerId, std::string const& targetId, int damage)
+void wars::Game::attackUnit(UnitId attackerId, UnitId targetId, int damage)
 {
   Event event;
   event.type = EventType::ATTACK;
-  event.attack.attackerId = &attackerId;
-  event.attack.targetId = &targetId;
+  event.attack.attackerId = attackerId;
+  event.attack.targetId = targetId;
   event.attack.damage = damage;
   eventStream.push(event);
 
-units.at(attackerId).moved = true;
-units.at(targetId).health -= damage;
+  setMoved(attackerId);
+  setField(JournalField::UNIT_HEALTH, units.health, targetId, units.health.at(targetId) - damage);
+
+  changed();
 }
 
-void wars::Game::counterattackUnit(std::string const& attackerId, std::string const& targetId, int damage)
+void wars::Game::counterattackUnit(UnitId attackerId, UnitId targetId, int damage)
 {
   Event event;
   event.type = EventType::COUNTERATTACK;
-  event.counterattack.attackerId = &attackerId;
-  event.counterattack.targetId = &targetId;
+  event.counterattack.attackerId = attackerId;
+  event.counterattack.targetId = targetId;
   event.counterattack.damage = damage;
   eventStream.push(event);
 
-  units.at(targetId).health -= damage;
+  setField(JournalField::UNIT_HEALTH, units.health, targetId, units.health.at(targetId) - damage);
+
+  changed();
 }
 
-void wars::Game::captureTile(std::string const& unitId, std::string const& tileId, int left)
+void wars::Game::captureTile(UnitId unitId, TileId tileId, int left)
 {
   Event event;
   event.type = EventType::CAPTURE;
-  event.capture.unitId = &unitId;
-  event.capture.tileId = &tileId;
+  event.capture.unitId = unitId;
+  event.capture.tileId = tileId;
   event.capture.left = left;
   eventStream.push(event);
 
-  units.at(unitId).moved = true;
-  Tile& tile = tiles.at(tileId);
-  tile.capturePoints = left;
-  tile.beingCaptured = true;
+  setMoved(unitId);
+  setField(JournalField::TILE_CAPTURE_POINTS, tiles.capturePoints, tileId, left);
+  setField(JournalField::TILE_BEING_CAPTURED, tiles.beingCaptured, tileId, true);
+
+  changed();
 }
 
-void wars::Game::capturedTile(std::string const& unitId, std::string const& tileId)
+void wars::Game::capturedTile(UnitId unitId, TileId tileId)
 {
   Event event;
   event.type = EventType::CAPTURED;
-  event.captured.unitId = &unitId;
-  event.captured.tileId = &tileId;
+  event.captured.unitId = unitId;
+  event.captured.tileId = tileId;
   eventStream.push(event);
 
-  Tile& tile = tiles.at(tileId);
-  tile.capturePoints = 1;
-  tile.beingCaptured = false;
-  tile.owner = units.at(unitId).owner;
+  setField(JournalField::TILE_CAPTURE_POINTS, tiles.capturePoints, tileId, 1);
+  setField(JournalField::TILE_BEING_CAPTURED, tiles.beingCaptured, tileId, false);
+  touchPlayer(tiles.owner.at(tileId));
+  touchPlayer(units.owner.at(unitId));
+  setField(JournalField::TILE_OWNER, tiles.owner, tileId, units.owner.at(unitId));
+
+  changed();
 }
 
-void wars::Game::deployUnit(std::string const& unitId)
+void wars::Game::deployUnit(UnitId unitId)
 {
   Event event;
   event.type = EventType::DEPLOY;
-  event.deploy.unitId = &unitId;
+  event.deploy.unitId = unitId;
   eventStream.push(event);
 
-  Unit& unit = units.at(unitId);
-  unit.moved = true;
-  unit.deployed = true;
+  setMoved(unitId);
+  setField(JournalField::UNIT_FLAGS, units.flags, unitId, units.flags.at(unitId) | UNIT_DEPLOYED);
+
+  changed();
 }
 
-void wars::Game::undeployUnit(std::string const& unitId)
+void wars::Game::undeployUnit(UnitId unitId)
 {
   Event event;
   event.type = EventType::UNDEPLOY;
-  event.undeploy.unitId = &unitId;
+  event.undeploy.unitId = unitId;
   eventStream.push(event);
 
-  Unit& unit = units.at(unitId);
-  unit.moved = true;
-  unit.deployed = false;
+  setMoved(unitId);
+  setField(JournalField::UNIT_FLAGS, units.flags, unitId, units.flags.at(unitId) & ~UNIT_DEPLOYED);
+
+  changed();
 }
 
-void wars::Game::loadUnit(std::string const& unitId, std::string const& carrierId)
+void wars::Game::loadUnit(UnitId unitId, UnitId carrierId)
 {
   Event event;
   event.type = EventType::LOAD;
-  event.load.unitId = &unitId;
-  event.load.carrierId = &carrierId;
+  event.load.unitId = unitId;
+  event.load.carrierId = carrierId;
   eventStream.push(event);
 
-  Unit& unit = units.at(unitId);
-  unit.tileId.clear();
-  unit.carriedBy = carrierId;
-  unit.moved = true;
-  Unit& carrier = units.at(carrierId);
-  carrier.carriedUnits.push_back(unitId);
+  occupancyChanged(units.tileId.at(unitId));
+  occupancyChanged(units.tileId.at(carrierId));
+  setField(JournalField::UNIT_TILE, units.tileId, unitId, NO_TILE);
+  setField(JournalField::UNIT_CARRIED_BY, units.carriedBy, unitId, carrierId);
+  setMoved(unitId);
+  journalCarriedUnits(carrierId);
+  units.carriedUnits.at(carrierId).push_back(unitId);
+
+  changed();
 }
 
-void wars::Game::unloadUnit(std::string const& unitId, std::string const& carrierId, std::string const& tileId)
+void wars::Game::unloadUnit(UnitId unitId, UnitId carrierId, TileId tileId)
 {
   Event event;
   event.type = EventType::UNLOAD;
-  event.unload.unitId = &unitId;
-  event.unload.carrierId = &carrierId;
-  event.unload.tileId = &tileId;
+  event.unload.unitId = unitId;
+  event.unload.carrierId = carrierId;
+  event.unload.tileId = tileId;
   eventStream.push(event);
 
-  Unit& unit = units.at(unitId);
-  unit.tileId = tileId;
-  unit.moved = true;
-  tiles.at(tileId).unitId = unitId;
-  Unit& carrier = units[carrierId];
-  carrier.moved = true;
-  std::remove(carrier.carriedUnits.begin(), carrier.carriedUnits.end(), unitId);
+  occupancyChanged(tileId);
+  occupancyChanged(units.tileId.at(carrierId));
+  setField(JournalField::UNIT_TILE, units.tileId, unitId, tileId);
+  setField(JournalField::UNIT_CARRIED_BY, units.carriedBy, unitId, NO_UNIT);
+  setMoved(unitId);
+  setTileUnit(tileId, unitId);
+  setMoved(carrierId);
+  journalCarriedUnits(carrierId);
+  std::vector<UnitId>& carried = units.carriedUnits.at(carrierId);
+  carried.erase(std::remove(carried.begin(), carried.end(), unitId), carried.end());
+
+  changed();
 }
 
-void wars::Game::destroyUnit(std::string const& unitId)
+void wars::Game::destroyUnit(UnitId unitId)
 {
   Event event;
   event.type = EventType::DESTROY;
-  event.destroy.unitId = &unitId;
+  event.destroy.unitId = unitId;
   eventStream.push(event);
 
-  Unit unit = units.at(unitId);
-  if(!unit.tileId.empty())
-    tiles.at(unit.tileId).unitId.erase();
+  // One change set with the carried units
+  beginBatch();
+
+  TileId tileId = units.tileId.at(unitId);
+  UnitId carrierId = units.carriedBy.at(unitId);
+  if(tileId != NO_TILE)
+  {
+    occupancyChanged(tileId);
+    setTileUnit(tileId, NO_UNIT);
+  }
+  else if(carrierId != NO_UNIT)
+  {
+    occupancyChanged(units.tileId.at(carrierId));
+    journalCarriedUnits(carrierId);
+    std::vector<UnitId>& carrierUnits = units.carriedUnits.at(carrierId);
+    carrierUnits.erase(std::remove(carrierUnits.begin(), carrierUnits.end(), unitId), carrierUnits.end());
+  }
 
-  for(std::string const& carriedUnitId : unit.carriedUnits)
+  journalCarriedUnits(unitId);
+  std::vector<UnitId> carried;
+  carried.swap(units.carriedUnits.at(unitId));
+  eventDepth += 1;
+  for(UnitId carriedUnitId : carried)
   {
     destroyUnit(carriedUnitId);
   }
+  eventDepth -= 1;
+
+  setField(JournalField::UNIT_TILE, units.tileId, unitId, NO_TILE);
+  setField(JournalField::UNIT_CARRIED_BY, units.carriedBy, unitId, NO_UNIT);
+  setField(JournalField::UNIT_FLAGS, units.flags, unitId, 0);
 
-  units.erase(unitId);
+  commitBatch();
 }
 
-void wars::Game::repairUnit(std::string const& unitId, int newHealth)
+void wars::Game::repairUnit(UnitId unitId, int newHealth)
 {
   Event event;
   event.type = EventType::REPAIR;
-  event.repair.unitId = &unitId;
+  event.repair.unitId = unitId;
   event.repair.newHealth = newHealth;
   eventStream.push(event);
 
-  units.at(unitId).health = newHealth;
+  setField(JournalField::UNIT_HEALTH, units.health, unitId, newHealth);
+
+  changed();
 }
 
-void wars::Game::buildUnit(std::string const& tileId, std::string const& unitId)
+void wars::Game::buildUnit(TileId tileId, UnitId unitId)
 {
   Event event;
   event.type = EventType::BUILD;
-  event.build.tileId = &tileId;
-  event.build.unitId = &unitId;
+  event.build.tileId = tileId;
+  event.build.unitId = unitId;
+  event.build.unitType = units.type.at(unitId);
+  event.build.owner = units.owner.at(unitId);
+  event.build.health = units.health.at(unitId);
   eventStream.push(event);
 
-  tiles.at(tileId).unitId = unitId;
-  units.at(unitId).moved = true;
+  occupancyChanged(tileId);
+  setTileUnit(tileId, unitId);
+  setMoved(unitId);
+  indexUnit(unitId);
+  touchPlayer(units.owner.at(unitId));
+
+  changed();
 }
 
-void wars::Game::regenerateCapturePointsTile(std::string const& tileId, int newCapturePoints)
+void wars::Game::regenerateCapturePointsTile(TileId tileId, int newCapturePoints)
 {
   Event event;
   event.type = EventType::REGENERATE_CAPTURE_POINTS;
-  event.regenerateCapturePoints.tileId = &tileId;
+  event.regenerateCapturePoints.tileId = tileId;
   event.regenerateCapturePoints.newCapturePoints = newCapturePoints;
   eventStream.push(event);
 
-  Tile& tile = tiles.at(tileId);
-  tile.capturePoints = newCapturePoints;
-  tile.beingCaptured = false;
+  setField(JournalField::TILE_CAPTURE_POINTS, tiles.capturePoints, tileId, newCapturePoints);
+  setField(JournalField::TILE_BEING_CAPTURED, tiles.beingCaptured, tileId, false);
 
+  changed();
 }
 
-void wars::Game::produceFundsTile(std::string const& tileId)
+void wars::Game::produceFundsTile(TileId tileId)
 {
   Event event;
   event.type = EventType::PRODUCE_FUNDS;
-  event.produceFunds.tileId = &tileId;
+  event.produceFunds.tileId = tileId;
   eventStream.push(event);
+
+  touchPlayer(tiles.owner.at(tileId));
+  changed();
 }
 
 void wars::Game::beginTurn(int playerNumber)
@@ -461,7 +796,12 @@ void wars::Game::beginTurn(int playerNumber)
   event.beginTurn.playerNumber = playerNumber;
   eventStream.push(event);
 
+  touchPlayer(inTurnNumber);
+  touchPlayer(playerNumber);
+  journal(JournalField::IN_TURN_NUMBER, 0, inTurnNumber);
   inTurnNumber = playerNumber;
+
+  changed();
 }
 
 void wars::Game::endTurn(int playerNumber)
@@ -471,11 +811,13 @@ void wars::Game::endTurn(int playerNumber)
   event.endTurn.playerNumber = playerNumber;
   eventStream.push(event);
 
-  for(auto& item : units)
-  {
-    Unit& unit = item.second;
-    unit.moved = false;
-  }
+  // Every unit is unmoved in the new generation. The units are not listed
+  // in the change set, the player is.
+  journal(JournalField::TURN_GENERATION, 0, units.turnGeneration);
+  units.turnGeneration += 1;
+  touchPlayer(playerNumber);
+
+  changed();
 }
 
 void wars::Game::turnTimeout(int playerNumber)
@@ -484,6 +826,9 @@ void wars::Game::turnTimeout(int playerNumber)
   event.type = EventType::TURN_TIMEOUT;
   event.turnTimeout.playerNumber = playerNumber;
   eventStream.push(event);
+
+  touchPlayer(playerNumber);
+  changed();
 }
 
 void wars::Game::finished(int winnerPlayerNumber)
@@ -493,7 +838,11 @@ void wars::Game::finished(int winnerPlayerNumber)
   event.finished.winnerPlayerNumber = winnerPlayerNumber;
   eventStream.push(event);
 
+  touchPlayer(winnerPlayerNumber);
+  journal(JournalField::STATE, 0, static_cast<int>(state));
   state = State::FINISHED;
+
+  changed();
 }
 
 void wars::Game::surrender(int playerNumber)
@@ -503,39 +852,81 @@ void wars::Game::surrender(int playerNumber)
   event.surrender.playerNumber = playerNumber;
   eventStream.push(event);
 
-  std::vector<std::string> unitsToDestroy;
-  for(auto& item : units)
-  {
-    Unit& unit = item.second;
-    if(unit.owner == playerNumber)
-    {
-      unitsToDestroy.push_back(unit.id);
-    }
-  }
+  // One change set with the destroyed units
+  beginBatch();
+  touchPlayer(playerNumber);
 
-  for(std::string const& unitId : unitsToDestroy)
+  // Copies in ID order, destroying and releasing tiles update the indexes
+  std::vector<UnitId> unitsToDestroy = getUnitsOwnedBy(playerNumber);
+  std::sort(unitsToDestroy.begin(), unitsToDestroy.end());
+  eventDepth += 1;
+  for(UnitId unitId : unitsToDestroy)
   {
-    destroyUnit(unitId);
+    // Carried units may already be gone with their carrier
+    if(units.exists(unitId))
+      destroyUnit(unitId);
   }
+  eventDepth -= 1;
 
-  for(auto& item : tiles)
+  std::vector<TileId> tilesToRelease = getTilesOwnedBy(playerNumber);
+  std::sort(tilesToRelease.begin(), tilesToRelease.end());
+  for(TileId tileId : tilesToRelease)
   {
-    Tile& tile = item.second;
-    if(tile.owner == playerNumber)
-    {
-      tile.owner = NEUTRAL_PLAYER_NUMBER;
-    }
+    setField(JournalField::TILE_OWNER, tiles.owner, tileId, NEUTRAL_PLAYER_NUMBER);
   }
+
+  commitBatch();
+}
+
+wars::Game::JournalMark wars::Game::mark()
+{
+  journalMarks.push_back(journalEntries.size());
+  return journalMarks.back();
+}
+
+void wars::Game::rollback(JournalMark position)
+{
+  if(journalMarks.empty() || journalMarks.back() != position)
+    throw std::logic_error("Rollback of a mark that is not the innermost open one");
+
+  revertJournal(position);
+  closeMark();
+}
+
+void wars::Game::commit(JournalMark position)
+{
+  if(journalMarks.empty() || journalMarks.back() != position)
+    throw std::logic_error("Commit of a mark that is not the innermost open one");
+
+  closeMark();
+}
+
+void wars::Game::beginBatch()
+{
+  batchDepth += 1;
+}
+
+void wars::Game::commitBatch()
+{
+  if(batchDepth > 0)
+    batchDepth -= 1;
+  changed();
 }
 
-wars::Game::Tile const & wars::Game::getTile(const std::string& tileId) const
+wars::Game::Tile wars::Game::getTile(TileId tileId) const
 {
-  return tiles.at(tileId);
+  if(tileId >= tiles.size())
+    throw std::out_of_range("No such tile");
+
+  return Tile(&tiles, tileId);
 }
 
-wars::Game::Unit const& wars::Game::getUnit(const std::string& unitId) const
+wars::Game::Unit wars::Game::getUnit(UnitId unitId) const
 {
-  return units.at(unitId);
+  if(!units.exists(unitId))
+    throw std::out_of_range("No such unit");
+
+  return Unit(&units, unitId);
 }
 
 wars::Game::Player const& wars::Game::getPlayer(int playerNumber) const
@@ -543,12 +934,12 @@ wars::Game::Player const& wars::Game::getPlayer(int playerNumber) const
   return players.at(playerNumber);
 }
 
-const std::unordered_map<std::string, wars::Game::Tile>& wars::Game::getTiles() const
+const wars::Game::TileStore& wars::Game::getTiles() const
 {
   return tiles;
 }
 
-const std::unordered_map<std::string, wars::Game::Unit>& wars::Game::getUnits() const
+const wars::Game::UnitStore& wars::Game::getUnits() const
 {
   return units;
 }
@@ -563,58 +954,102 @@ const wars::Rules& wars::Game::getRules() const
   return rules;
 }
 
+const wars::DamageTable& wars::Game::getDamageTable() const
+{
+  return damageTable;
+}
+
+const wars::RuleTables& wars::Game::getRuleTables() const
+{
+  return ruleTables;
+}
+
+const wars::IdTable& wars::Game::getTileIds() const
+{
+  return tileIds;
+}
+
+const wars::IdTable& wars::Game::getUnitIds() const
+{
+  return unitIds;
+}
+
 wars::Game::Player const& wars::Game::getInTurn()
 {
   return players.at(inTurnNumber) ;
 }
 
-const wars::Game::Tile* wars::Game::getTileAt(int x, int y) const
+int wars::Game::getInTurnNumber() const
 {
-  for(auto const& item : tiles)
-  {
-    if(item.second.x == x && item.second.y == y)
-    {
-      return &item.second;
-    }
-  }
+  return inTurnNumber;
+}
 
-  return nullptr;
+wars::Game::State wars::Game::getState() const
+{
+  return state;
 }
 
-const std::string& wars::Game::getGameId() const
+wars::Game::TileId wars::Game::getTileAt(int x, int y) const
 {
-  return gameId;
+  int index = gridIndex(x, y);
+  return index >= 0 ? tileGrid[index] : NO_TILE;
 }
 
-int wars::Game::calculateDistance(const wars::Game::Coordinates& a, const wars::Game::Coordinates& b) const
+wars::Game::UnitId wars::Game::getUnitAt(int x, int y) const
 {
-  int distance = 0;
-  Coordinates aa = a;
-  Coordinates bb = b;
+  int index = gridIndex(x, y);
+  return index >= 0 ? unitGrid[index] : NO_UNIT;
+}
 
-  if(a.x < b.x && a.y > b.y)
-  {
-    int diagonal = std::min(b.x - a.x, a.y - b.y);
-    aa.x += diagonal;
-    aa.y -= diagonal;
-    distance += diagonal;
-  }
-  else if(a.x > b.x && a.y < b.y)
-  {
-    int diagonal = std::min(a.x - b.x, b.y - a.y);
-    bb.x += diagonal;
-    bb.y -= diagonal;
-    distance += diagonal;
-  }
-  distance += std::abs(bb.x - aa.x);
-  distance += std::abs(bb.y - aa.y);
-  return distance;
+std::vector<wars::Game::UnitId> const& wars::Game::getUnitsOwnedBy(int playerNumber) const
+{
+  return unitsByOwner.get(playerNumber);
 }
 
-bool wars::Game::areAllies(int playerNumber1, int playerNumber2) const
+std::vector<wars::Game::TileId> const& wars::Game::getTilesOwnedBy(int playerNumber) const
 {
-  if(playerNumber1 == 0)
-  {
+  return tilesByOwner.get(playerNumber);
+}
+
+std::vector<wars::Game::TileId> const& wars::Game::getTilesOfType(int terrainId) const
+{
+  return tilesByType.get(terrainId);
+}
+
+wars::Bitboard const& wars::Game::getOccupiedBoard() const
+{
+  return occupiedBoard;
+}
+
+wars::Bitboard const& wars::Game::getOwnerBoard(int playerNumber) const
+{
+  if(playerNumber < 0 || static_cast<std::size_t>(playerNumber) >= ownerBoards.size())
+    return emptyBoard;
+
+  return ownerBoards[playerNumber];
+}
+
+wars::Bitboard const& wars::Game::getPassableBoard(int movementTypeId) const
+{
+  return passableBoards.at(movementTypeId);
+}
+
+const std::string& wars::Game::getGameId() const
+{
+  return gameId;
+}
+
+bool wars::Game::areAllies(int playerNumber1, int playerNumber2) const
+{
+  // Negative numbers wrap past the matrix
+  std::size_t const row1 = static_cast<unsigned int>(playerNumber1);
+  std::size_t const row2 = static_cast<unsigned int>(playerNumber2);
+  if(row1 < allianceMasks.size() && row2 < allianceMasks.size() && allianceMasks[row1] && allianceMasks[row2])
+    return (allianceMasks[row1] >> row2) & 1;
+
+  // Unknown players throw below
+  if(playerNumber1 == 0)
+  {
     return playerNumber2 == 0;
   }
   else if(playerNumber2 == 0)
@@ -631,329 +1066,383 @@ bool wars::Game::areAllies(int playerNumber1, int playerNumber2) const
 
 wars::Game::Path wars::Game::findShortestPath(const wars::Game::Coordinates& a, const wars::Game::Coordinates& b) const
 {
-  std::map<Coordinates, Tile const*> grid;
-  for(auto const& item : tiles)
+  TileId const startId = getTileAt(a.x, a.y);
+  TileId const endId = getTileAt(b.x, b.y);
+  if(startId == NO_TILE || endId == NO_TILE)
   {
-    Coordinates pos = {item.second.x, item.second.y};
-    grid[pos] = &item.second;
+    return {};
   }
 
-  if(grid.find(a) == grid.end() || grid.find(b) == grid.end())
+  return findPath(startId, endId, UniformCost(*this, b));
+}
+
+wars::Game::Path wars::Game::findUnitPath(UnitId unitId, const wars::Game::Coordinates& destination) const
+{
+  Unit const unit = getUnit(unitId);
+  TileId const endId = getTileAt(destination.x, destination.y);
+  if(endId == NO_TILE || unit.tileId() == NO_TILE)
   {
     return {};
   }
-  typedef std::tuple<int, Coordinates, Coordinates, int> Node; // distance, tile, from, cost
-  std::vector<Node> nodes = {std::make_tuple(calculateDistance(a, b), a, a, 0)};
 
-  std::map<Coordinates, Node> visited;
-  Path path;
+  return findPath(unit.tileId(), endId, UnitMovementCost(*this, unitId, destination));
+}
 
-  bool newNodes = false;
-  while(!nodes.empty())
+std::shared_ptr<wars::Game::DistanceField const> wars::Game::getDistanceField(int movementTypeId, TileId targetId, int playerNumber) const
+{
+  DistanceFieldKey key = std::make_tuple(movementTypeId, targetId, playerNumber);
+  auto iter = distanceFields.find(key);
+  if(iter != distanceFields.end())
   {
-    // Get node
-    Node node = nodes.back();
-    nodes.pop_back();
+    iter->second.lastUse = ++distanceFieldUses;
+    return iter->second.field;
+  }
 
-    // Add node to visited
-    Coordinates pos = {std::get<1>(node).x, std::get<1>(node).y};
-    visited[pos] = node;
+  ruleTables.minMovementCost(movementTypeId); // Throws on unknown types
 
-    // Check end condition
-    if(pos == b)
+  if(distanceFields.size() >= MAX_DISTANCE_FIELDS)
+  {
+    auto oldest = distanceFields.begin();
+    for(auto i = distanceFields.begin(); i != distanceFields.end(); ++i)
     {
-      Node const* n = &node;
-      while(n != nullptr)
-      {
-        path.push_back(std::get<1>(*n));
-        n = std::get<1>(*n) == std::get<2>(*n) ? nullptr : &visited.at(std::get<2>(*n));
-      }
-      std::reverse(path.begin(), path.end());
-      break;
+      if(i->second.lastUse < oldest->second.lastUse)
+        oldest = i;
     }
-    // Process neighbors
-    for(Coordinates neighborPos : neighborCoordinates(pos))
-    {
-      auto iter = grid.find(neighborPos);
+    distanceFields.erase(oldest);
+  }
 
-      // Reject if does not exist
-      if(iter == grid.end())
-        continue;
+  std::shared_ptr<DistanceField> result = std::make_shared<DistanceField>();
+  DistanceField& field = *result;
+  field.costs.assign(tiles.size(), -1);
+  field.next.assign(tiles.size(), NO_TILE);
 
-      // Reject if visited
-      if(visited.find(neighborPos) != visited.end())
-        continue;
+  // Dijkstra from the target over reversed edges, stepping from a tile to
+  // its neighbor costs entering the tile
+  typedef std::pair<int, TileId> Node; // cost, tile
+  std::priority_queue<Node, std::vector<Node>, std::greater<Node>> nodes;
+  field.costs.at(targetId) = 0;
+  field.next[targetId] = targetId;
+  nodes.push(std::make_pair(0, targetId));
 
-      // Check if already in queue
-      auto existingIter = std::find_if(nodes.begin(), nodes.end(), [&neighborPos](Node const& n) {
-        return std::get<1>(n) == neighborPos;
-      });
+  while(!nodes.empty())
+  {
+    Node node = nodes.top();
+    nodes.pop();
 
-      // Determine cost
-      int cost = std::get<3>(node) + 1;
+    TileId nodeId = node.second;
+    if(node.first != field.costs[nodeId])
+      continue;
 
-      if(existingIter == nodes.end())
-      {
-        // Add node to queue if new position
-        nodes.push_back(std::make_tuple(calculateDistance(neighborPos, b), neighborPos, pos, cost));
-        newNodes = true;
-      }
-      else if(cost < std::get<3>(*existingIter))
-      {
-        // Update existing if shorter route
-        *existingIter = std::make_tuple(calculateDistance(neighborPos, b), neighborPos, pos, cost);
-        newNodes = true;
-      }
-    }
+    // An impassable target is free to enter, so fields towards an enemy
+    // unit measure the approach to it
+    int tileCost = movementCost(movementTypeId, playerNumber, nodeId);
+    if(tileCost < 0 && nodeId != targetId)
+      continue;
 
-    if(newNodes)
+    for(std::uint32_t i = adjacencyOffsets[nodeId]; i < adjacencyOffsets[nodeId + 1]; ++i)
     {
-      std::stable_sort(nodes.begin(), nodes.end());
+      TileId neighborId = adjacency[i];
+      int cost = node.first + std::max(tileCost, 0);
+      if(field.costs[neighborId] >= 0 && field.costs[neighborId] <= cost)
+        continue;
+
+      field.costs[neighborId] = cost;
+      field.next[neighborId] = nodeId;
+      nodes.push(std::make_pair(cost, neighborId));
     }
   }
 
-  return path;
+  distanceFields[key] = {result, ++distanceFieldUses};
+  return result;
 }
 
-wars::Game::Path wars::Game::findUnitPath(const std::string& unitId, const wars::Game::Coordinates& destination) const
+wars::Game::Path wars::Game::findFieldPath(UnitId unitId, Coordinates const& destination) const
 {
-  Unit const& unit = getUnit(unitId);
-  Tile const& startTile = getTile(unit.tileId);
-  Coordinates const start = {startTile.x, startTile.y};
-  UnitType const& unitType = rules.unitTypes.at(unit.type);
-  MovementType const& movementType = rules.movementTypes.at(unitType.movementType);
+  Unit const unit = getUnit(unitId);
+  TileId const endId = getTileAt(destination.x, destination.y);
+  if(endId == NO_TILE || unit.tileId() == NO_TILE)
+  {
+    return {};
+  }
+
+  std::shared_ptr<DistanceField const> fieldPtr = getDistanceField(ruleTables.movementType(unit.type()), endId, unit.owner());
+  DistanceField const& field = *fieldPtr;
 
-  std::map<Coordinates, Tile const*> grid;
-  for(auto const& item : tiles)
+  // Walk down the field
+  Path path;
+  TileId tileId = unit.tileId();
+  if(field.next[tileId] == NO_TILE)
   {
-    Coordinates pos = {item.second.x, item.second.y};
-    grid[pos] = &item.second;
+    return path;
   }
 
-  if(grid.find(destination) == grid.end())
+  path.push_back({tiles.x[tileId], tiles.y[tileId]});
+  while(tileId != endId)
   {
-    return {};
+    tileId = field.next[tileId];
+    path.push_back({tiles.x[tileId], tiles.y[tileId]});
   }
-  typedef std::tuple<int, Coordinates, Coordinates, int> Node; // distance, tile, from, cost
-  std::vector<Node> nodes = {std::make_tuple(calculateDistance(start, destination), start, start, 0)};
 
-  std::map<Coordinates, Node> visited;
-  Path path;
+  return path;
+}
 
-  bool newNodes = false;
-  while(!nodes.empty())
+std::vector<wars::Game::Coordinates> wars::Game::neighborCoordinates(const wars::Game::Coordinates& pos) const
+{
+  std::vector<Coordinates> result;
+  result.reserve(Topology::NUM_DIRECTIONS);
+  forEachNeighbor(pos, [&](Coordinates const& neighbor) {
+    result.push_back(neighbor);
+  });
+  return result;
+}
+
+std::vector<wars::Game::Coordinates> wars::Game::findMovementOptions(UnitId unitId) const
+{
+  if(unitId < movementOptionsCache.size() && movementOptionsCache[unitId].valid)
   {
-    // Get node
-    Node node = nodes.back();
-    nodes.pop_back();
+    return movementOptionsCache[unitId].options;
+  }
 
-    // Add node to visited
-    Coordinates pos = {std::get<1>(node).x, std::get<1>(node).y};
-    visited[pos] = node;
+  Unit const unit = getUnit(unitId);
+  std::vector<TileId> reachable;
+  computeMovementOptions(unitId, movementScratch, reachable);
 
-    // Check end condition
-    if(pos == destination)
-    {
-      Node const* n = &node;
-      while(n != nullptr)
-      {
-        path.push_back(std::get<1>(*n));
-        n = std::get<1>(*n) == std::get<2>(*n) ? nullptr : &visited.at(std::get<2>(*n));
-      }
-      std::reverse(path.begin(), path.end());
-      break;
-    }
-    // Process neighbors
-    for(Coordinates neighborPos : neighborCoordinates(pos))
-    {
-      auto iter = grid.find(neighborPos);
+  std::vector<Coordinates> options;
+  options.reserve(reachable.size());
+  for(TileId tileId : reachable)
+  {
+    options.push_back({tiles.x[tileId], tiles.y[tileId]});
+  }
 
-      // Reject if does not exist
-      if(iter == grid.end())
-        continue;
+  // Only tiles within movement / cheapest step of the unit can change the
+  // result, zero cost terrain makes that unbounded
+  int minCost = ruleTables.minMovementCost(ruleTables.movementType(unit.type()));
 
-      // Reject if visited
-      if(visited.find(neighborPos) != visited.end())
-        continue;
+  if(movementOptionsCache.size() < units.size())
+    movementOptionsCache.resize(units.size());
 
-      // Determine cost
-      Tile const* tile = iter->second;
-      int tileCost = 1;
-      auto effectIter = movementType.effectMap.find(tile->type);
-      if(effectIter != movementType.effectMap.end())
-      {
-        tileCost = effectIter->second;
-      }
+  MovementOptionsCache& cache = movementOptionsCache[unitId];
+  cache.options = options;
+  cache.origin = unit.tileId();
+  cache.radius = minCost > 0 ? ruleTables.movement(unit.type()) / minCost : -1;
+  cache.valid = true;
 
-      // Reject if cannot traverse
-      if(tileCost < 0)
-        continue;
+  return options;
+}
 
-      int cost = std::get<3>(node) + tileCost;
+wars::Bitboard wars::Game::findReachableBoard(UnitId unitId) const
+{
+  Bitboard result = emptyBoard;
+  for(Coordinates const& pos : findMovementOptions(unitId))
+  {
+    result.set(pos.x, pos.y);
+  }
+  return result;
+}
 
-      // Reject if not enough movement points
-      if(cost > unitType.movement)
-        continue;
+wars::Game::MovementOptionSet wars::Game::findAllMovementOptions(int playerNumber) const
+{
+  MovementOptionSet result;
+  for(UnitId unitId : getUnitsOwnedBy(playerNumber))
+  {
+    if(units.tileId[unitId] != NO_TILE)
+      result.unitIds.push_back(unitId);
+  }
+  std::sort(result.unitIds.begin(), result.unitIds.end());
 
-      // Reject if contains enemy unit
-      if(!tile->unitId.empty() && areAllies(unit.owner, getUnit(tile->unitId).owner))
-        continue;
+  if(!workerPool)
+  {
+    workerPool.reset(new WorkerPool());
+    workerScratches.resize(workerPool->concurrency());
+  }
 
-      // Check if already in queue
-      auto existingIter = std::find_if(nodes.begin(), nodes.end(), [&neighborPos](Node const& n) {
-        return std::get<1>(n) == neighborPos;
-      });
+  // Searches only read game state, each worker gets its own scratch space
+  std::vector<std::vector<TileId>> reachable(result.unitIds.size());
+  workerPool->parallelFor(result.unitIds.size(), [&](std::size_t i, unsigned int worker) {
+    computeMovementOptions(result.unitIds[i], workerScratches[worker], reachable[i]);
+  });
 
-      if(existingIter == nodes.end())
-      {
-        // Add node to queue if new position
-        nodes.push_back(std::make_tuple(calculateDistance(neighborPos, destination), neighborPos, pos, cost));
-        newNodes = true;
-      }
-      else if(cost < std::get<3>(*existingIter))
-      {
-        // Update existing if shorter route
-        *existingIter = std::make_tuple(calculateDistance(neighborPos, destination), neighborPos, pos, cost);
-        newNodes = true;
-      }
-    }
-
-    if(newNodes)
-    {
-      std::stable_sort(nodes.begin(), nodes.end());
-    }
+  std::size_t numTileIds = 0;
+  for(std::vector<TileId> const& tileIds : reachable)
+  {
+    numTileIds += tileIds.size();
   }
 
-  return path;
-}
+  result.offsets.reserve(reachable.size() + 1);
+  result.tileIds.reserve(numTileIds);
+  for(std::vector<TileId> const& tileIds : reachable)
+  {
+    result.offsets.push_back(result.tileIds.size());
+    result.tileIds.insert(result.tileIds.end(), tileIds.begin(), tileIds.end());
+  }
+  result.offsets.push_back(result.tileIds.size());
 
-std::vector<wars::Game::Coordinates> wars::Game::neighborCoordinates(const wars::Game::Coordinates& pos) const
-{
-  return {
-    {pos.x + 1, pos.y},
-    {pos.x - 1, pos.y},
-    {pos.x, pos.y + 1},
-    {pos.x, pos.y - 1},
-    {pos.x + 1, pos.y - 1},
-    {pos.x - 1, pos.y + 1},
-  };
+  return result;
 }
 
-std::vector<wars::Game::Coordinates> wars::Game::findMovementOptions(const std::string& unitId) const
+void wars::Game::computeMovementOptions(UnitId unitId, MovementScratch& scratch, std::vector<TileId>& result) const
 {
-  Unit const& unit = getUnit(unitId);
-  Tile const& startTile = getTile(unit.tileId);
-  Coordinates const start = {startTile.x, startTile.y};
-  UnitType const& unitType = rules.unitTypes.at(unit.type);
-  MovementType const& movementType = rules.movementTypes.at(unitType.movementType);
+  Unit const unit = getUnit(unitId);
+  TileId const startId = unit.tileId();
+  int const movementType = ruleTables.movementType(unit.type());
+  int const unitClass = ruleTables.unitClass(unit.type());
 
-  std::map<Coordinates, Tile const*> grid;
-  for(auto const& item : tiles)
+  if(ruleTables.uniformMovementCost(movementType))
   {
-    Coordinates pos = {item.second.x, item.second.y};
-    grid[pos] = &item.second;
+    floodMovementOptions(unitId, scratch, result);
+    return;
   }
 
-  typedef std::tuple<int, Coordinates, Coordinates> Node; // cost, tile, from
-  std::vector<Node> nodes = {std::make_tuple(0, start, start)};
-
-  std::map<Coordinates, Node> visited;
+  // Dial's algorithm: tile costs are small non-negative integers and total
+  // cost is capped by unit movement, so one bucket per cost value suffices
+  int const maxCost = std::max(ruleTables.movement(unit.type()), 0);
+  if(scratch.costs.size() != tiles.size())
+    scratch.costs.assign(tiles.size(), -1);
+  if(scratch.buckets.size() < static_cast<std::size_t>(maxCost + 1))
+    scratch.buckets.resize(maxCost + 1);
 
-  bool newNodes = false;
-  while(!nodes.empty())
-  {
-    // Get node
-    Node node = nodes.back();
-    nodes.pop_back();
+  std::vector<std::vector<TileId>>& buckets = scratch.buckets;
+  std::vector<int>& costs = scratch.costs;
+  std::vector<TileId>& reached = scratch.reached;
 
-    // Add node to visited
-    Coordinates pos = {std::get<1>(node).x, std::get<1>(node).y};
-    visited[pos] = node;
+  costs.at(startId) = 0;
+  buckets[0].push_back(startId);
 
-    // Process neighbors
-    for(Coordinates neighborPos : neighborCoordinates(pos))
+  for(int cost = 0; cost <= maxCost; ++cost)
+  {
+    // Index based, zero cost moves append to the bucket being processed
+    std::vector<TileId>& bucket = buckets[cost];
+    for(std::size_t b = 0; b < bucket.size(); ++b)
     {
-      auto iter = grid.find(neighborPos);
+      TileId nodeId = bucket[b];
 
-      // Reject if does not exist
-      if(iter == grid.end())
+      // Skip if a cheaper route was already processed
+      if(costs[nodeId] != cost)
         continue;
 
-      // Reject if visited
-      if(visited.find(neighborPos) != visited.end())
-        continue;
+      reached.push_back(nodeId);
 
-      // Determine cost
-      Tile const* tile = iter->second;
-      int tileCost = 1;
-      auto effectIter = movementType.effectMap.find(tile->type);
-      if(effectIter != movementType.effectMap.end())
+      // Process neighbors
+      for(std::uint32_t i = adjacencyOffsets[nodeId]; i < adjacencyOffsets[nodeId + 1]; ++i)
       {
-        tileCost = effectIter->second;
-      }
+        TileId neighborId = adjacency[i];
 
-      // Reject if cannot traverse
-      if(tileCost < 0)
-        continue;
+        // Determine cost
+        int tileCost = ruleTables.movementCost(movementType, tiles.type[neighborId]);
 
-      int cost = std::get<0>(node) + tileCost;
+        // Reject if cannot traverse
+        if(tileCost < 0)
+          continue;
 
-      // Reject if not enough movement points
-      if(cost > unitType.movement)
-        continue;
+        int neighborCost = cost + tileCost;
 
-      // Reject if contains enemy unit
-      if(!tile->unitId.empty() && !areAllies(unit.owner, getUnit(tile->unitId).owner))
-        continue;
+        // Reject if not enough movement points
+        if(neighborCost > maxCost)
+          continue;
 
-      // Check if already in queue
-      auto existingIter = std::find_if(nodes.begin(), nodes.end(), [&neighborPos](Node const& n) {
-        return std::get<1>(n) == neighborPos;
-      });
+        // Reject if not shorter than a known route
+        if(costs[neighborId] >= 0 && costs[neighborId] <= neighborCost)
+          continue;
 
-      if(existingIter == nodes.end())
-      {
-        // Add node to queue if new position
-        nodes.push_back(std::make_tuple(cost, neighborPos, pos));
-        newNodes = true;
-      }
-      else if(cost < std::get<0>(*existingIter))
-      {
-        // Update existing if shorter route
-        *existingIter = std::make_tuple(cost, neighborPos, pos);
-        newNodes = true;
+        // Reject if contains enemy unit
+        UnitId tileUnitId = tiles.unitId[neighborId];
+        if(tileUnitId != NO_UNIT && !areAllies(unit.owner(), units.owner[tileUnitId]))
+          continue;
+
+        costs[neighborId] = neighborCost;
+        buckets[neighborCost].push_back(neighborId);
       }
     }
+    bucket.clear();
+  }
 
-    if(newNodes)
+  // Every tile with a cost was pushed to a bucket and settled, since costs
+  // never exceed maxCost. Resetting the reached ones restores the scratch.
+  result.clear();
+  for(TileId tileId : reached)
+  {
+    costs[tileId] = -1;
+  }
+
+  for(TileId tileId : reached)
+  {
+    // Skip if tile has a unit that cannot carry this one and isn't self
+    UnitId tileUnitId = tiles.unitId[tileId];
+    if(tileUnitId != NO_UNIT && tileUnitId != unitId)
     {
-      std::stable_sort(nodes.begin(), nodes.end());
+      // A negative carryNum means no limit
+      Unit const tileUnit = getUnit(tileUnitId);
+      int const carryNum = ruleTables.carryNum(tileUnit.type());
+      if(tileUnit.owner() != unit.owner()
+         || (carryNum >= 0 && tileUnit.carriedUnits().size() >= static_cast<std::size_t>(carryNum))
+         || !ruleTables.canCarry(tileUnit.type(), unitClass))
+      {
+        continue;
+      }
     }
+
+    result.push_back(tileId);
   }
+  reached.clear();
+}
 
-  std::vector<Coordinates> result;
-  for(auto const& item : visited)
+void wars::Game::floodMovementOptions(UnitId unitId, MovementScratch& scratch, std::vector<TileId>& result) const
+{
+  Unit const unit = getUnit(unitId);
+  TileId const startId = unit.tileId();
+  int const movementType = ruleTables.movementType(unit.type());
+  int const unitClass = ruleTables.unitClass(unit.type());
+  int const steps = std::max(ruleTables.movement(unit.type()), 0);
+
+  Bitboard& reached = scratch.reachedBoard;
+  Bitboard& blocked = scratch.blockedBoard;
+  if(!reached.sameArea(occupiedBoard))
   {
-    Coordinates const& pos = item.first;
+    reached = emptyBoard;
+    blocked = emptyBoard;
+  }
+
+  // Every step costs 1, so the tiles within movement steps through passable
+  // tiles without enemy units are those Dial's algorithm would settle. No
+  // step leaves the square of steps around the start.
+  Coordinates const start = {tiles.x.at(startId), tiles.y[startId]};
+  int const x0 = start.x - steps;
+  int const y0 = start.y - steps;
+  int const x1 = start.x + steps;
+  int const y1 = start.y + steps;
+
+  occupiedBoard.forEachInArea(x0, y0, x1, y1, [&](int x, int y) {
+    if(!areAllies(unit.owner(), units.owner[getUnitAt(x, y)]))
+      blocked.set(x, y);
+  });
+
+  reached.set(start.x, start.y);
+  reached.flood<Topology>(getPassableBoard(movementType), blocked, steps, x0, y0, x1, y1);
+
+  result.clear();
+  reached.forEachInArea(x0, y0, x1, y1, [&](int x, int y) {
+    TileId tileId = getTileAt(x, y);
 
     // Skip if tile has a unit that cannot carry this one and isn't self
-    Tile const* tile = grid.at(pos);
-    if(!tile->unitId.empty() && tile->unitId != unitId)
+    UnitId tileUnitId = tiles.unitId[tileId];
+    if(tileUnitId != NO_UNIT && tileUnitId != unitId)
     {
-      Unit const& tileUnit = getUnit(tile->unitId);
-      UnitType const& tileUnitType = rules.unitTypes.at(tileUnit.type);
-      if(tileUnit.owner != unit.owner
-         || tileUnit.carriedUnits.size() >= tileUnitType.carryNum
-         || tileUnitType.carryClasses.find(unitType.unitClass) == tileUnitType.carryClasses.end())
+      // A negative carryNum means no limit
+      Unit const tileUnit = getUnit(tileUnitId);
+      int const carryNum = ruleTables.carryNum(tileUnit.type());
+      if(tileUnit.owner() != unit.owner()
+         || (carryNum >= 0 && tileUnit.carriedUnits().size() >= static_cast<std::size_t>(carryNum))
+         || !ruleTables.canCarry(tileUnit.type(), unitClass))
       {
-        continue;
+        return;
       }
     }
 
-    result.push_back(pos);
-  }
+    result.push_back(tileId);
+  });
 
-  return result;
+  reached.clearArea(x0, y0, x1, y1);
+  blocked.clearArea(x0, y0, x1, y1);
 }
 
 int wars::Game::calculateWeaponPower(Weapon const& weapon, int armorId, int distance) const
@@ -972,168 +1461,144 @@ int wars::Game::calculateWeaponPower(Weapon const& weapon, int armorId, int dist
 int wars::Game::calculateAttackDamage(UnitType const& attackerType, int attackerHealth, bool attackerDeployed,
                                       UnitType const& targetType, int targetHealth, int distance, int targetTerrainId) const
 {
-
-  // Calculate best attack power
-  int power = -1;
-  int weaponIds[] = {attackerType.primaryWeapon, attackerType.secondaryWeapon};
-  for(int weaponId : weaponIds)
-  {
-    if(weaponId < 0)
-      continue;
-
-    Weapon const& weapon = rules.weapons.at(weaponId);
-
-    if(weapon.requireDeployed && !attackerDeployed)
-      continue;
-
-    int weaponPower = calculateWeaponPower(weapon, targetType.armor, distance);
-    power = std::max(power, weaponPower);
-  }
-
-  // Reject if cannot attack
-  if(power < 0)
-    return -1;
-
-  // Determine enemy defense
-  TerrainType const& targetTerrain = rules.terrainTypes.at(targetTerrainId);
-  auto defenseIter = targetType.defenseMap.find(targetTerrainId);
-  int defense = defenseIter != targetType.defenseMap.end() ? defenseIter->second : targetTerrain.defense;
-
-  // Calculate damage
-  int damage = attackerHealth * power * (100 - (defense * targetHealth / 100)) / 100 / 100;
-
-  // Minimum damage is 1
-  return std::max(damage, 1);
+  return damageTable.damage(attackerType.id, attackerHealth, attackerDeployed,
+                            targetType.id, targetHealth, distance, targetTerrainId);
 }
 
-std::unordered_map<std::string, int> wars::Game::findAttackOptions(const std::string& unitId, const wars::Game::Coordinates& position) const
+void wars::Game::calculateAttackDamages(int const* attackerHealth, int const* targetHealth, int const* power,
+                                        int const* defense, int* damage, std::size_t count) const
 {
-  int minRange = -1;
-  int maxRange = -1;
-
-  Unit const& unit = getUnit(unitId);
+  DamageTable::damages(attackerHealth, targetHealth, power, defense, damage, count);
+}
 
-  UnitType const& unitType = rules.unitTypes.at(unit.type);
-  int weaponIds[] = {unitType.primaryWeapon, unitType.secondaryWeapon};
+void wars::Game::calculateDistances(Coordinates const& origin, int const* xs, int const* ys, int* distances,
+                                    std::size_t count) const
+{
+  Topology::distances(origin.x, origin.y, xs, ys, distances, count);
+}
 
-  // Determine range limits for usable weapons
-  for(int weaponId : weaponIds)
+void wars::Game::calculateDistanceMatrix(int const* originXs, int const* originYs, std::size_t numOrigins,
+                                         int const* xs, int const* ys, std::size_t count, int* distances) const
+{
+  // One row per origin, the row loop is vectorized over the positions
+  for(std::size_t i = 0; i < numOrigins; ++i)
   {
-    if(weaponId < 0)
-      continue;
+    Topology::distances(originXs[i], originYs[i], xs, ys, distances + i * count, count);
+  }
+}
 
-    Weapon const* weapon = &rules.weapons.at(weaponId);
+std::unordered_map<wars::Game::UnitId, int> wars::Game::findAttackOptions(UnitId unitId, const wars::Game::Coordinates& position) const
+{
+  Unit const unit = getUnit(unitId);
 
-    if(weapon->requireDeployed && !unit.deployed)
-      continue;
+  UnitType const& unitType = rules.unitTypes.at(unit.type());
 
-    for(auto const& item : weapon->rangeMap)
-    {
-      minRange = minRange >= 0 ? std::min(minRange, item.first) : item.first;
-      maxRange = maxRange >= 0 ? std::max(maxRange, item.first) : item.first;
-    }
-  }
+  // Range limits for usable weapons
+  int minRange = ruleTables.minRange(unit.type(), unit.deployed());
+  int maxRange = ruleTables.maxRange(unit.type(), unit.deployed());
 
   // Return empty set if no usable weapons
   if(minRange < 0 || maxRange < 0)
     return {};
 
   // Find attackable units and damages
-  std::unordered_map<std::string, int> result;
-  for(auto const& item : tiles)
-  {
+  std::unordered_map<UnitId, int> result;
+  forEachTileInRange(position, minRange, maxRange, [&](TileId tileId, int distance) {
     // Reject if no unit
-    Tile const& enemyTile = item.second;
-    if(enemyTile.unitId.empty())
-      continue;
-
-    // Reject if out of range
-    int distance = calculateDistance(position, {enemyTile.x, enemyTile.y});
-    if(distance < minRange && distance > maxRange)
-      continue;
+    UnitId enemyId = tiles.unitId[tileId];
+    if(enemyId == NO_UNIT)
+      return;
 
     // Reject if unit is ally
-    Unit const& enemy = getUnit(enemyTile.unitId);
-    if(areAllies(unit.owner, enemy.owner))
-      continue;
+    if(areAllies(unit.owner(), units.owner[enemyId]))
+      return;
 
-    UnitType enemyType = rules.unitTypes.at(enemy.type);
+    UnitType const& enemyType = rules.unitTypes.at(units.type[enemyId]);
 
     // Calculate damage
-    int damage = calculateAttackDamage(unitType, unit.health, unit.deployed, enemyType, enemy.health, distance, enemyTile.type);
+    int damage = calculateAttackDamage(unitType, unit.health(), unit.deployed(), enemyType, units.health[enemyId], distance, tiles.type[tileId]);
 
     // Add result if attack is possible
     if(damage >= 0)
-      result[enemy.id] = damage;
-  }
+      result[enemyId] = damage;
+  });
 
   return result;
 }
 
-std::string wars::Game::updateTileFromJSON(const json::Value& value)
+wars::Game::TileId wars::Game::updateTileFromJSON(const json::Value& value)
 {
-  Tile tile;
-  tile.id = value.get("tileId").stringValue();
-  tile.x = value.get("x").longValue();
-  tile.y = value.get("y").longValue();
-  tile.type = value.get("type").longValue();
-  tile.subtype = value.get("subtype").longValue();
-  tile.owner = value.get("owner").longValue();
-  tile.capturePoints = value.get("capturePoints").longValue();
-  tile.beingCaptured = value.get("beingCaptured").booleanValue();
-  tile.unitId = parseStringOrNull(value.get("unitId"), "");
+  TileId tileId = tileIds.intern(value.get("tileId").stringValue());
+  if(tileId >= tiles.size())
+    tiles.resize(tileId + 1);
+
+  tiles.x[tileId] = value.get("x").longValue();
+  tiles.y[tileId] = value.get("y").longValue();
+  tiles.type[tileId] = value.get("type").longValue();
+  tiles.subtype[tileId] = value.get("subtype").longValue();
+  tiles.owner[tileId] = value.get("owner").longValue();
+  tiles.capturePoints[tileId] = value.get("capturePoints").longValue();
+  tiles.beingCaptured[tileId] = value.get("beingCaptured").booleanValue();
+  tiles.unitId[tileId] = NO_UNIT;
 
-  if(!tile.unitId.empty())
+  if(value.get("unitId").type() != json::Value::Type::NULL_JSON)
   {
-    updateUnitFromJSON(value.get("unit"));
+    tiles.unitId[tileId] = updateUnitFromJSON(value.get("unit"));
   }
 
-  tiles[tile.id] = tile;
-  return tile.id;
+  return tileId;
 }
 
-std::string wars::Game::updateUnitFromJSON(const json::Value& value)
+wars::Game::UnitId wars::Game::updateUnitFromJSON(const json::Value& value)
 {
-  std::string unitId = value.get("unitId").stringValue();
+  UnitId unitId = unitIds.intern(value.get("unitId").stringValue());
+  if(unitId >= units.size())
+    units.resize(unitId + 1);
+  if(unitId < movementOptionsCache.size())
+    movementOptionsCache[unitId].valid = false;
 
-  auto iter = units.find(unitId);
-  if(iter == units.end())
+  std::uint8_t flags = units.flags[unitId];
+  if(!(flags & UNIT_ALIVE))
   {
-    Unit u;
-    u.id = unitId;
-    units[unitId] = u;
+    flags = UNIT_ALIVE;
+    setField(JournalField::UNIT_MOVED_TURN, units.movedTurn, unitId, 0);
+    setField(JournalField::UNIT_TILE, units.tileId, unitId, NO_TILE);
+    setField(JournalField::UNIT_CARRIED_BY, units.carriedBy, unitId, NO_UNIT);
+    journalCarriedUnits(unitId);
+    units.carriedUnits[unitId].clear();
   }
-  Unit& unit =  units[unitId];
 
   if(value.has("owner"))
-    unit.owner = value.get("owner").longValue();
+    setField(JournalField::UNIT_OWNER, units.owner, unitId, value.get("owner").longValue());
   if(value.has("type"))
-    unit.type = value.get("type").longValue();
+    setField(JournalField::UNIT_TYPE, units.type, unitId, value.get("type").longValue());
   if(value.has("tileId"))
-    unit.tileId = parseStringOrNull(value.get("tileId"), "");
+    setField(JournalField::UNIT_TILE, units.tileId, unitId, parseHandleOrNull(value.get("tileId"), tileIds, NO_TILE));
   if(value.has("carriedBy"))
-    unit.carriedBy = parseStringOrNull(value.get("carriedBy"), "");
+    setField(JournalField::UNIT_CARRIED_BY, units.carriedBy, unitId, parseHandleOrNull(value.get("carriedBy"), unitIds, NO_UNIT));
   if(value.has("health"))
-    unit.health = value.get("health").longValue();
+    setField(JournalField::UNIT_HEALTH, units.health, unitId, value.get("health").longValue());
   if(value.has("deployed"))
-    unit.deployed = value.get("deployed").booleanValue();
+    setFlag(flags, UNIT_DEPLOYED, value.get("deployed").booleanValue());
   if(value.has("moved"))
-    unit.moved = value.get("moved").booleanValue();
+    setField(JournalField::UNIT_MOVED_TURN, units.movedTurn, unitId, value.get("moved").booleanValue() ? units.turnGeneration : 0);
   if(value.has("capturing"))
-    unit.capturing = value.get("capturing").booleanValue();
+    setFlag(flags, UNIT_CAPTURING, value.get("capturing").booleanValue());
+  setField(JournalField::UNIT_FLAGS, units.flags, unitId, flags);
 
   if(value.has("carriedUnits"))
   {
+    journalCarriedUnits(unitId);
     json::Value carriedUnits = value.get("carriedUnits");
     unsigned int numCarriedUnits = carriedUnits.size();
     for(unsigned int i = 0; i < numCarriedUnits; ++i)
     {
       json::Value carriedUnit = carriedUnits.at(i);
-      std::string carriedUnitId = updateUnitFromJSON(carriedUnit);
-      unit.carriedUnits.push_back(carriedUnitId);
+      UnitId carriedUnitId = updateUnitFromJSON(carriedUnit);
+      units.carriedUnits[unitId].push_back(carriedUnitId);
     }
   }
-  return unit.id;
+  return unitId;
 }
 
 int wars::Game::updatePlayerFromJSON(const json::Value& value)
@@ -1175,6 +1640,542 @@ int wars::Game::updatePlayerFromJSON(const json::Value& value)
   return playerNumber;
 }
 
+void wars::Game::buildGridIndex()
+{
+  tileGrid.clear();
+  unitGrid.clear();
+  gridMinX = gridMinY = gridWidth = gridHeight = 0;
+
+  std::size_t numTiles = tiles.size();
+  if(numTiles == 0)
+    return;
+
+  int maxX = tiles.x[0];
+  int maxY = tiles.y[0];
+  gridMinX = maxX;
+  gridMinY = maxY;
+  for(std::size_t i = 0; i < numTiles; ++i)
+  {
+    gridMinX = std::min(gridMinX, tiles.x[i]);
+    gridMinY = std::min(gridMinY, tiles.y[i]);
+    maxX = std::max(maxX, tiles.x[i]);
+    maxY = std::max(maxY, tiles.y[i]);
+  }
+
+  gridWidth = maxX - gridMinX + 1;
+  gridHeight = maxY - gridMinY + 1;
+  tileGrid.assign(gridWidth * gridHeight, NO_TILE);
+  unitGrid.assign(gridWidth * gridHeight, NO_UNIT);
+
+  for(TileId tileId = 0; tileId < numTiles; ++tileId)
+  {
+    int index = gridIndex(tiles.x[tileId], tiles.y[tileId]);
+    tileGrid[index] = tileId;
+    unitGrid[index] = tiles.unitId[tileId];
+  }
+}
+
+void wars::Game::buildIndexes()
+{
+  unitsByOwner.clear();
+  tilesByOwner.clear();
+  tilesByType.clear();
+  emptyBoard = Bitboard(gridMinX, gridMinY, gridWidth, gridHeight);
+  occupiedBoard = emptyBoard;
+  ownerBoards.clear();
+  for(TileId tileId = 0; tileId < tiles.size(); ++tileId)
+  {
+    indexTileOwner(tileId);
+    tilesByType.set(tileId, tiles.type[tileId]);
+    if(tiles.unitId[tileId] != NO_UNIT)
+      occupiedBoard.set(tiles.x[tileId], tiles.y[tileId]);
+  }
+  buildPassableBoards();
+  for(UnitId unitId = 0; unitId < units.size(); ++unitId)
+  {
+    indexUnit(unitId);
+  }
+
+  int numRows = 1;
+  for(auto const& item : players)
+  {
+    if(item.first > 0 && item.first < 64)
+      numRows = std::max(numRows, item.first + 1);
+  }
+
+  // The neutral player is only allied with itself
+  allianceMasks.assign(numRows, 0);
+  allianceMasks[NEUTRAL_PLAYER_NUMBER] = 1;
+  for(auto const& player1 : players)
+  {
+    for(auto const& player2 : players)
+    {
+      if(player1.first > 0 && player1.first < numRows && player2.first > 0 && player2.first < numRows
+         && player1.second.teamNumber == player2.second.teamNumber)
+        allianceMasks[player1.first] |= std::uint64_t(1) << player2.first;
+    }
+  }
+}
+
+void wars::Game::indexUnit(UnitId unitId)
+{
+  unitsByOwner.set(unitId, units.exists(unitId) ? units.owner[unitId] : -1);
+}
+
+void wars::Game::indexTileOwner(TileId tileId)
+{
+  // The owner index still holds the previous owner
+  int x = tiles.x[tileId];
+  int y = tiles.y[tileId];
+  int previous = tileId < tilesByOwner.keys.size() ? tilesByOwner.keys[tileId] : -1;
+  if(previous >= 0 && static_cast<std::size_t>(previous) < ownerBoards.size())
+    ownerBoards[previous].reset(x, y);
+
+  int owner = tiles.owner[tileId];
+  if(owner >= 0)
+  {
+    if(static_cast<std::size_t>(owner) >= ownerBoards.size())
+      ownerBoards.resize(owner + 1, emptyBoard);
+    ownerBoards[owner].set(x, y);
+  }
+  tilesByOwner.set(tileId, owner);
+}
+
+void wars::Game::buildPassableBoards()
+{
+  int numMovementTypes = 0;
+  for(auto const& item : rules.movementTypes)
+  {
+    numMovementTypes = std::max(numMovementTypes, item.first + 1);
+  }
+
+  passableBoards.assign(numMovementTypes, emptyBoard);
+  for(auto const& item : rules.movementTypes)
+  {
+    Bitboard& board = passableBoards[item.first];
+    for(TileId tileId = 0; tileId < tiles.size(); ++tileId)
+    {
+      if(ruleTables.movementCost(item.first, tiles.type[tileId]) >= 0)
+        board.set(tiles.x[tileId], tiles.y[tileId]);
+    }
+  }
+}
+
+void wars::Game::buildAdjacency()
+{
+  std::size_t numTiles = tiles.size();
+  adjacencyOffsets.assign(numTiles + 1, 0);
+  adjacency.clear();
+  adjacency.reserve(numTiles * Topology::NUM_DIRECTIONS);
+
+  for(TileId tileId = 0; tileId < numTiles; ++tileId)
+  {
+    adjacencyOffsets[tileId] = adjacency.size();
+    forEachNeighbor({tiles.x[tileId], tiles.y[tileId]}, [&](Coordinates const& pos) {
+      TileId neighborId = getTileAt(pos.x, pos.y);
+      if(neighborId != NO_TILE)
+        adjacency.push_back(neighborId);
+    });
+  }
+  adjacencyOffsets[numTiles] = adjacency.size();
+}
+
+template<typename Policy>
+wars::Game::Path wars::Game::findPath(TileId startId, TileId endId, Policy const& policy) const
+{
+  std::vector<TileId> nodes;
+  pathSearch.search(adjacencyOffsets, adjacency, startId, endId, policy, nodes);
+
+  Path path;
+  path.reserve(nodes.size());
+  for(TileId tileId : nodes)
+  {
+    path.push_back({tiles.x[tileId], tiles.y[tileId]});
+  }
+  return path;
+}
+
+void wars::Game::occupancyChanged(TileId tileId)
+{
+  invalidateMovementOptionsNear(tileId);
+  invalidateDistanceFields(tileId);
+}
+
+void wars::Game::invalidateDistanceFields(TileId tileId)
+{
+  if(tileId == NO_TILE)
+    return;
+
+  // A tile that cannot reach the target is on no route, blocking or
+  // unblocking it changes nothing
+  for(auto iter = distanceFields.begin(); iter != distanceFields.end();)
+  {
+    if(iter->second.field->costs.at(tileId) >= 0)
+      iter = distanceFields.erase(iter);
+    else
+      ++iter;
+  }
+}
+
+int wars::Game::movementCost(int movementTypeId, int playerNumber, TileId tileId) const
+{
+  // Reject if contains enemy unit
+  UnitId tileUnitId = tiles.unitId[tileId];
+  if(tileUnitId != NO_UNIT && !areAllies(playerNumber, units.owner[tileUnitId]))
+    return -1;
+
+  return ruleTables.movementCost(movementTypeId, tiles.type[tileId]);
+}
+
+void wars::Game::invalidateMovementOptionsNear(TileId tileId)
+{
+  if(tileId == NO_TILE)
+    return;
+
+  Coordinates const pos = {tiles.x.at(tileId), tiles.y.at(tileId)};
+  for(MovementOptionsCache& cache : movementOptionsCache)
+  {
+    if(!cache.valid)
+      continue;
+
+    Coordinates const origin = {tiles.x[cache.origin], tiles.y[cache.origin]};
+    if(cache.radius < 0 || calculateDistance(origin, pos) <= cache.radius)
+      cache.valid = false;
+  }
+}
+
+int wars::Game::gridIndex(int x, int y) const
+{
+  int gx = x - gridMinX;
+  int gy = y - gridMinY;
+  if(gx < 0 || gy < 0 || gx >= gridWidth || gy >= gridHeight)
+    return -1;
+
+  return gy * gridWidth + gx;
+}
+
+void wars::Game::setTileUnit(TileId tileId, UnitId unitId)
+{
+  setField(JournalField::TILE_UNIT, tiles.unitId, tileId, unitId);
+
+  int index = gridIndex(tiles.x[tileId], tiles.y[tileId]);
+  if(index >= 0)
+    unitGrid[index] = unitId;
+
+  if(unitId != NO_UNIT)
+    occupiedBoard.set(tiles.x[tileId], tiles.y[tileId]);
+  else
+    occupiedBoard.reset(tiles.x[tileId], tiles.y[tileId]);
+}
+
+void wars::Game::journal(JournalField field, std::uint32_t index, std::int64_t value)
+{
+  if(!journalMarks.empty())
+    journalEntries.push_back({field, index, value});
+}
+
+void wars::Game::journalCarriedUnits(UnitId unitId)
+{
+  touchUnit(unitId);
+  if(!journalMarks.empty())
+  {
+    journal(JournalField::UNIT_CARRIED_UNITS, unitId, journalCarriedUnitLists.size());
+    journalCarriedUnitLists.push_back(units.carriedUnits.at(unitId));
+  }
+}
+
+void wars::Game::revert(JournalEntry const& entry)
+{
+  std::uint32_t index = entry.index;
+  switch(entry.field)
+  {
+    case JournalField::TILE_OWNER:
+      tiles.owner[index] = entry.value;
+      break;
+    case JournalField::TILE_UNIT:
+      occupancyChanged(index);
+      setTileUnit(index, entry.value);
+      break;
+    case JournalField::TILE_CAPTURE_POINTS:
+      tiles.capturePoints[index] = entry.value;
+      break;
+    case JournalField::TILE_BEING_CAPTURED:
+      tiles.beingCaptured[index] = entry.value;
+      break;
+    case JournalField::UNIT_TILE:
+      occupancyChanged(units.tileId[index]);
+      occupancyChanged(entry.value);
+      if(index < movementOptionsCache.size())
+        movementOptionsCache[index].valid = false;
+      units.tileId[index] = entry.value;
+      break;
+    case JournalField::UNIT_TYPE:
+    case JournalField::UNIT_OWNER:
+      // Both change how the unit moves and who it blocks
+      occupancyChanged(units.tileId[index]);
+      if(index < movementOptionsCache.size())
+        movementOptionsCache[index].valid = false;
+      if(entry.field == JournalField::UNIT_TYPE)
+        units.type[index] = entry.value;
+      else
+        units.owner[index] = entry.value;
+      break;
+    case JournalField::UNIT_HEALTH:
+      units.health[index] = entry.value;
+      break;
+    case JournalField::UNIT_CARRIED_BY:
+      units.carriedBy[index] = entry.value;
+      break;
+    case JournalField::UNIT_FLAGS:
+      units.flags[index] = entry.value;
+      break;
+    case JournalField::UNIT_MOVED_TURN:
+      units.movedTurn[index] = entry.value;
+      break;
+    case JournalField::UNIT_CARRIED_UNITS:
+      // Lists are saved and restored in stack order
+      units.carriedUnits[index].swap(journalCarriedUnitLists.back());
+      journalCarriedUnitLists.pop_back();
+      break;
+    case JournalField::IN_TURN_NUMBER:
+      inTurnNumber = entry.value;
+      break;
+    case JournalField::TURN_GENERATION:
+      units.turnGeneration = entry.value;
+      break;
+    case JournalField::STATE:
+      state = static_cast<State>(entry.value);
+      break;
+  }
+  indexField(entry.field, index);
+}
+
+void wars::Game::revertJournal(std::size_t position)
+{
+  revertedTileIds.clear();
+  revertedUnitIds.clear();
+  bool reverted = journalEntries.size() > position;
+  bool allUnits = false;
+
+  // Reverting must not record anything itself
+  std::vector<JournalMark> marks;
+  marks.swap(journalMarks);
+  while(journalEntries.size() > position)
+  {
+    JournalEntry const& entry = journalEntries.back();
+    if(entry.field <= JournalField::TILE_BEING_CAPTURED)
+    {
+      revertedTileIds.push_back(entry.index);
+    }
+    else if(entry.field <= JournalField::UNIT_CARRIED_UNITS)
+    {
+      revertedUnitIds.push_back(entry.index);
+    }
+    else if(entry.field == JournalField::IN_TURN_NUMBER)
+    {
+      touchPlayer(inTurnNumber);
+      touchPlayer(entry.value);
+    }
+    else if(entry.field == JournalField::TURN_GENERATION)
+    {
+      // Changes moved() of every unit
+      allUnits = true;
+    }
+    revert(entry);
+    journalEntries.pop_back();
+  }
+  marks.swap(journalMarks);
+
+  if(!reverted)
+    return;
+
+  if(allUnits)
+  {
+    revertedUnitIds.resize(units.size());
+    for(UnitId unitId = 0; unitId < units.size(); ++unitId)
+      revertedUnitIds[unitId] = unitId;
+  }
+
+  std::sort(revertedTileIds.begin(), revertedTileIds.end());
+  revertedTileIds.erase(std::unique(revertedTileIds.begin(), revertedTileIds.end()), revertedTileIds.end());
+  std::sort(revertedUnitIds.begin(), revertedUnitIds.end());
+  revertedUnitIds.erase(std::unique(revertedUnitIds.begin(), revertedUnitIds.end()), revertedUnitIds.end());
+  for(TileId tileId : revertedTileIds)
+    touchTile(tileId);
+  for(UnitId unitId : revertedUnitIds)
+    touchUnit(unitId);
+
+  Event event;
+  event.type = EventType::ROLLBACK;
+  event.rollback.tileIds = revertedTileIds.data();
+  event.rollback.numTileIds = revertedTileIds.size();
+  event.rollback.unitIds = revertedUnitIds.data();
+  event.rollback.numUnitIds = revertedUnitIds.size();
+  eventStream.push(event);
+
+  changed();
+}
+
+void wars::Game::closeMark()
+{
+  // Changes are kept in the journal until the outermost mark is closed
+  journalMarks.pop_back();
+  if(journalMarks.empty())
+  {
+    journalEntries.clear();
+    journalCarriedUnitLists.clear();
+  }
+}
+
+void wars::Game::indexField(JournalField field, std::uint32_t index)
+{
+  if(field == JournalField::TILE_OWNER)
+    indexTileOwner(index);
+  else if(field == JournalField::UNIT_OWNER || field == JournalField::UNIT_FLAGS)
+    indexUnit(index);
+}
+
+void wars::Game::setMoved(UnitId unitId)
+{
+  setField(JournalField::UNIT_MOVED_TURN, units.movedTurn, unitId, units.turnGeneration);
+}
+
+void wars::Game::touchTile(TileId tileId)
+{
+  if(tileId >= tileTouched.size())
+    tileTouched.resize(std::max<std::size_t>(tileId + 1, tiles.size()), 0);
+
+  if(!tileTouched[tileId])
+  {
+    tileTouched[tileId] = 1;
+    pendingChanges.tileIds.push_back(tileId);
+  }
+}
+
+void wars::Game::touchUnit(UnitId unitId)
+{
+  if(unitId >= unitTouched.size())
+    unitTouched.resize(std::max<std::size_t>(unitId + 1, units.size()), 0);
+
+  if(!unitTouched[unitId])
+  {
+    unitTouched[unitId] = 1;
+    pendingChanges.unitIds.push_back(unitId);
+  }
+}
+
+void wars::Game::touchPlayer(int playerNumber)
+{
+  // Few players, a linear search is enough
+  std::vector<int>& playerNumbers = pendingChanges.playerNumbers;
+  if(std::find(playerNumbers.begin(), playerNumbers.end(), playerNumber) == playerNumbers.end())
+    playerNumbers.push_back(playerNumber);
+}
+
+void wars::Game::touchAll()
+{
+  pendingChanges.reset = true;
+}
+
+void wars::Game::changed()
+{
+  if(batchDepth > 0)
+    return;
+
+  if(pendingChanges.reset || !pendingChanges.tileIds.empty() || !pendingChanges.unitIds.empty()
+     || !pendingChanges.playerNumbers.empty())
+  {
+    changeStream.push(pendingChanges);
+  }
+
+  for(TileId tileId : pendingChanges.tileIds)
+    tileTouched[tileId] = 0;
+  for(UnitId unitId : pendingChanges.unitIds)
+    unitTouched[unitId] = 0;
+  pendingChanges.tileIds.clear();
+  pendingChanges.unitIds.clear();
+  pendingChanges.playerNumbers.clear();
+  pendingChanges.reset = false;
+}
+
+void wars::Game::GroupIndex::set(Handle handle, int key)
+{
+  if(handle >= keys.size())
+  {
+    keys.resize(handle + 1, -1);
+    positions.resize(handle + 1, 0);
+  }
+
+  int const oldKey = keys[handle];
+  if(oldKey == key)
+    return;
+
+  if(oldKey >= 0)
+  {
+    std::vector<Handle>& group = groups[oldKey];
+    Handle last = group.back();
+    group[positions[handle]] = last;
+    positions[last] = positions[handle];
+    group.pop_back();
+  }
+
+  keys[handle] = key;
+  if(key >= 0)
+  {
+    if(static_cast<std::size_t>(key) >= groups.size())
+      groups.resize(key + 1);
+    positions[handle] = groups[key].size();
+    groups[key].push_back(handle);
+  }
+}
+
+std::vector<wars::Handle> const& wars::Game::GroupIndex::get(int key) const
+{
+  static std::vector<Handle> const none;
+  return key >= 0 && static_cast<std::size_t>(key) < groups.size() ? groups[key] : none;
+}
+
+void wars::Game::GroupIndex::clear()
+{
+  groups.clear();
+  keys.clear();
+  positions.clear();
+}
+
+void wars::Game::TileStore::resize(std::size_t n)
+{
+  x.resize(n, 0);
+  y.resize(n, 0);
+  type.resize(n, 0);
+  subtype.resize(n, 0);
+  owner.resize(n, 0);
+  unitId.resize(n, NO_UNIT);
+  capturePoints.resize(n, 0);
+  beingCaptured.resize(n, 0);
+}
+
+void wars::Game::TileStore::clear()
+{
+  resize(0);
+}
+
+void wars::Game::UnitStore::resize(std::size_t n)
+{
+  tileId.resize(n, NO_TILE);
+  type.resize(n, 0);
+  owner.resize(n, 0);
+  health.resize(n, 0);
+  carriedBy.resize(n, NO_UNIT);
+  flags.resize(n, 0);
+  carriedUnits.resize(n);
+  movedTurn.resize(n, 0);
+}
+
+void wars::Game::UnitStore::clear()
+{
+  resize(0);
+}
+
 namespace
 {
   template<typename T>
@@ -1273,6 +2274,7 @@ namespace
     wars::TerrainType value;
     value.id = v.get("id").longValue();
     value.name = v.get("name").stringValue();
+    value.defense = v.get("defense").longValue();
     value.buildTypes = parseIntSet(v.get("buildTypes"));
     value.repairTypes = parseIntSet(v.get("repairTypes"));
     value.flags = parseIntSet(v.get("flags"));
@@ -1366,6 +2368,61 @@ namespace
     }
 
   }
+  wars::Handle parseHandleOrNull(json::Value const& v, wars::IdTable& ids, wars::Handle nullValue)
+  {
+    if(v.type() == json::Value::Type::NULL_JSON)
+    {
+      return nullValue;
+    }
+    else
+    {
+      return ids.intern(v.stringValue());
+    }
+  }
+  void setFlag(std::uint8_t& flags, std::uint8_t flag, bool value)
+  {
+    flags = value ? (flags | flag) : (flags & ~flag);
+  }
+
+  std::uint64_t mortonIndex(std::uint32_t x, std::uint32_t y)
+  {
+    // Interleave the bits, x takes the even ones
+    std::uint64_t bits[2] = {x, y};
+    for(std::uint64_t& v : bits)
+    {
+      v = (v | (v << 16)) & 0x0000ffff0000ffffull;
+      v = (v | (v << 8)) & 0x00ff00ff00ff00ffull;
+      v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0full;
+      v = (v | (v << 2)) & 0x3333333333333333ull;
+      v = (v | (v << 1)) & 0x5555555555555555ull;
+    }
+    return bits[0] | bits[1] << 1;
+  }
+
+  std::uint64_t hilbertIndex(std::uint32_t size, std::uint32_t x, std::uint32_t y)
+  {
+    // Distance along the curve filling a size x size square, size is a power of two
+    std::uint64_t index = 0;
+    for(std::uint32_t s = size / 2; s > 0; s /= 2)
+    {
+      std::uint32_t rx = (x & s) ? 1 : 0;
+      std::uint32_t ry = (y & s) ? 1 : 0;
+      index += std::uint64_t(s) * s * ((3 * rx) ^ ry);
+
+      // Rotate the quadrant so the curve continues in the next one
+      if(ry == 0)
+      {
+        if(rx == 1)
+        {
+          x = size - 1 - x;
+          y = size - 1 - y;
+        }
+        std::swap(x, y);
+      }
+    }
+    return index;
+  }
+
   wars::Game::Path parsePath(json::Value const& v)
   {
     wars::Game::Path path;
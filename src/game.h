@@ -5,9 +5,21 @@
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
+#include <map>
+#include <tuple>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
 
 #include "rules.h"
 #include "stream.h"
+#include "idtable.h"
+#include "astar.h"
+#include "damagetable.h"
+#include "ruletables.h"
+#include "hextopology.h"
+#include "bitboard.h"
+#include "workerpool.h"
 
 namespace json
 {
@@ -16,6 +28,8 @@ namespace json
 
 namespace wars
 {
+  class EventLog;
+
   class Game
   {
   public:
@@ -29,13 +43,21 @@ namespace wars
       int y;
     };
     typedef std::vector<Coordinates> Path;
+    // Neighbours, distances and range walks of every search are compiled
+    // against this, see hextopology.h
+    typedef AxialHex Topology;
+    typedef Handle TileId;
+    typedef Handle UnitId;
+    typedef std::size_t JournalMark;
     static const int NEUTRAL_PLAYER_NUMBER = 0;
+    static const TileId NO_TILE = INVALID_HANDLE;
+    static const UnitId NO_UNIT = INVALID_HANDLE;
 
     enum class EventType {
       GAMEDATA, MOVE, WAIT, ATTACK, COUNTERATTACK, CAPTURE, CAPTURED,
       DEPLOY, UNDEPLOY, LOAD, UNLOAD, DESTROY, REPAIR, BUILD,
       REGENERATE_CAPTURE_POINTS, PRODUCE_FUNDS, BEGIN_TURN,
-      END_TURN, TURN_TIMEOUT, FINISHED, SURRENDER
+      END_TURN, TURN_TIMEOUT, FINISHED, SURRENDER, ROLLBACK
     };
 
     struct Event
@@ -45,78 +67,81 @@ namespace wars
       {
         struct
         {
-          std::string const* unitId;
-          std::string const* tileId;
+          UnitId unitId;
+          TileId tileId;
           Path const* path;
         } move;
         struct
         {
-          std::string const* unitId;
+          UnitId unitId;
         } wait;
         struct
         {
-          std::string const* attackerId;
-          std::string const* targetId;
+          UnitId attackerId;
+          UnitId targetId;
           int damage;
         } attack;
         struct
         {
-          std::string const* attackerId;
-          std::string const* targetId;
+          UnitId attackerId;
+          UnitId targetId;
           int damage;
         } counterattack;
         struct
         {
-          std::string const* unitId;
-          std::string const* tileId;
+          UnitId unitId;
+          TileId tileId;
           int left;
         } capture;
         struct
         {
-          std::string const* unitId;
-          std::string const* tileId;
+          UnitId unitId;
+          TileId tileId;
         } captured;
         struct
         {
-          std::string const* unitId;
+          UnitId unitId;
         } deploy;
         struct
         {
-          std::string const* unitId;
+          UnitId unitId;
         } undeploy;
         struct
         {
-          std::string const* unitId;
-          std::string const* carrierId;
+          UnitId unitId;
+          UnitId carrierId;
         } load;
         struct
         {
-          std::string const* unitId;
-          std::string const* carrierId;
-          std::string const* tileId;
+          UnitId unitId;
+          UnitId carrierId;
+          TileId tileId;
         } unload;
         struct
         {
-          std::string const* unitId;
+          UnitId unitId;
         } destroy;
         struct
         {
-          std::string const* unitId;
+          UnitId unitId;
           int newHealth;
         } repair;
         struct
         {
-          std::string const* tileId;
-          std::string const* unitId;
+          TileId tileId;
+          UnitId unitId;
+          int unitType;
+          int owner;
+          int health;
         } build;
         struct
         {
-          std::string const* tileId;
+          TileId tileId;
           int newCapturePoints;
         } regenerateCapturePoints;
         struct
         {
-          std::string const* tileId;
+          TileId tileId;
         } produceFunds;
         struct
         {
@@ -138,41 +163,108 @@ namespace wars
         {
           int playerNumber;
         } surrender;
+        struct
+        {
+          // Tiles and units whose state was reverted, in ID order
+          TileId const* tileIds;
+          std::size_t numTileIds;
+          UnitId const* unitIds;
+          std::size_t numUnitIds;
+        } rollback;
       };
     };
 
-    struct Tile
+    // UNIT_MOVED is not kept in UnitStore::flags, see UnitStore::moved
+    enum UnitFlag : std::uint8_t
     {
-      std::string id;
-      int x;
-      int y;
-      int type;
-      int subtype;
-      int owner;
-      std::string unitId;
-      int capturePoints;
-      bool beingCaptured;
-
-      Tile() : id(), x(0), y(0), type(0), subtype(0), owner(0),
-        unitId(), capturePoints(0), beingCaptured(false)
-      {}
+      UNIT_ALIVE = 1 << 0,
+      UNIT_DEPLOYED = 1 << 1,
+      UNIT_MOVED = 1 << 2,
+      UNIT_CAPTURING = 1 << 3
     };
-    struct Unit
+
+    // Tile columns indexed by TileId
+    struct TileStore
     {
-      std::string id;
-      std::string tileId;
-      int type;
-      int owner;
-      std::string carriedBy;
-      int health;
-      bool deployed;
-      bool moved;
-      bool capturing;
-      std::vector<std::string> carriedUnits;
-
-      Unit() : id(), tileId(), type(0), owner(0), carriedBy(), health(0),
-        deployed(false), moved(false), capturing(false), carriedUnits()
-      {}
+      std::vector<int> x;
+      std::vector<int> y;
+      std::vector<int> type;
+      std::vector<int> subtype;
+      std::vector<int> owner;
+      std::vector<UnitId> unitId;
+      std::vector<int> capturePoints;
+      std::vector<std::uint8_t> beingCaptured;
+
+      std::size_t size() const { return x.size(); }
+      void resize(std::size_t n);
+      void clear();
+    };
+
+    // Unit columns indexed by UnitId, destroyed units keep their slot without UNIT_ALIVE
+    struct UnitStore
+    {
+      std::vector<TileId> tileId;
+      std::vector<int> type;
+      std::vector<int> owner;
+      std::vector<int> health;
+      std::vector<UnitId> carriedBy;
+      std::vector<std::uint8_t> flags;
+      std::vector<std::vector<UnitId>> carriedUnits;
+      // Turn generation a unit last moved in, 0 for never. endTurn bumps
+      // turnGeneration instead of clearing every unit.
+      std::vector<std::uint32_t> movedTurn;
+      std::uint32_t turnGeneration = 1;
+
+      std::size_t size() const { return flags.size(); }
+      bool exists(UnitId id) const { return id < flags.size() && (flags[id] & UNIT_ALIVE); }
+      bool moved(UnitId id) const { return movedTurn[id] == turnGeneration; }
+      void resize(std::size_t n);
+      void clear();
+    };
+
+    // Read-only view of a single tile in TileStore
+    class Tile
+    {
+    public:
+      TileId id() const { return _id; }
+      int x() const { return _store->x[_id]; }
+      int y() const { return _store->y[_id]; }
+      int type() const { return _store->type[_id]; }
+      int subtype() const { return _store->subtype[_id]; }
+      int owner() const { return _store->owner[_id]; }
+      UnitId unitId() const { return _store->unitId[_id]; }
+      int capturePoints() const { return _store->capturePoints[_id]; }
+      bool beingCaptured() const { return _store->beingCaptured[_id] != 0; }
+
+    private:
+      friend class Game;
+      Tile(TileStore const* store, TileId id) : _store(store), _id(id) {}
+
+      TileStore const* _store;
+      TileId _id;
+    };
+
+    // Read-only view of a single unit in UnitStore
+    class Unit
+    {
+    public:
+      UnitId id() const { return _id; }
+      TileId tileId() const { return _store->tileId[_id]; }
+      int type() const { return _store->type[_id]; }
+      int owner() const { return _store->owner[_id]; }
+      UnitId carriedBy() const { return _store->carriedBy[_id]; }
+      int health() const { return _store->health[_id]; }
+      bool deployed() const { return _store->flags[_id] & UNIT_DEPLOYED; }
+      bool moved() const { return _store->moved(_id); }
+      bool capturing() const { return _store->flags[_id] & UNIT_CAPTURING; }
+      std::vector<UnitId> const& carriedUnits() const { return _store->carriedUnits[_id]; }
+
+    private:
+      friend class Game;
+      Unit(UnitStore const* store, UnitId id) : _store(store), _id(id) {}
+
+      UnitStore const* _store;
+      UnitId _id;
     };
 
     struct Player
@@ -193,70 +285,231 @@ namespace wars
       {}
     };
 
+    // Reverse Dijkstra result towards a single target tile
+    struct DistanceField
+    {
+      std::vector<int> costs; // Cost to reach the target, -1 if unreachable
+      std::vector<TileId> next; // Next tile towards the target, NO_TILE if unreachable
+    };
+
+    // Reachable tiles of several units in CSR form, the options of unitIds[i]
+    // are tileIds[offsets[i]] .. tileIds[offsets[i + 1] - 1]
+    struct MovementOptionSet
+    {
+      std::vector<UnitId> unitIds;
+      std::vector<std::uint32_t> offsets;
+      std::vector<TileId> tileIds;
+    };
+
+    // Tiles, units and players changed since the last change set, each listed
+    // once. reset means the whole state was replaced.
+    struct ChangeSet
+    {
+      std::vector<TileId> tileIds;
+      std::vector<UnitId> unitIds;
+      std::vector<int> playerNumbers;
+      bool reset;
+    };
+
+    // Order of the TileIds assigned when game data is loaded. The space
+    // filling curves run over axial coordinates and keep neighbouring tiles
+    // close in the tile columns, RECEIVED keeps the server order.
+    enum class TileLayout { RECEIVED, MORTON, HILBERT };
+
     Game();
     ~Game();
 
+    // Events are pushed one by one before they are applied
     Stream<Event> events();
+    // Change sets are pushed after each applied event, or once per batch
+    Stream<ChangeSet> changes();
 
+    // Replacing the rules of a loaded game pushes GAMEDATA and a reset
+    // change set, cached movement and distances are dropped
     void setRulesFromJSON(json::Value const& value);
+    // Takes effect on the next setGameDataFromJSON, MORTON by default
+    void setTileLayout(TileLayout layout);
     void setGameDataFromJSON(json::Value const& value);
     void processEventFromJSON(json::Value const& value);
+    // Applies the events as one batch
     void processEventsFromJSON(json::Value const& value);
+    // Rebuilds state from a log recorded with EventLog, see EventLog::replay
+    void replay(EventLog const& log);
 
     // Game event handlers
-    void moveUnit(std::string const& unitId, std::string const& tileId, Path const& path);
-    void waitUnit(std::string const& unitId);
-    void attackUnit(std::string const& attackerId, std::string const& targetId, int damage);
-    void counterattackUnit(std::string const& attackerId, std::string const& targetId, int damage);
-    void captureTile(std::string const& unitId, std::string const& tileId, int left);
-    void capturedTile(std::string const& unitId, std::string const& tileId);
-    void deployUnit(std::string const& unitId);
-    void undeployUnit(std::string const& unitId);
-    void loadUnit(std::string const& unitId, std::string const& carrierId);
-    void unloadUnit(std::string const& unitId, std::string const& carrierId, std::string const& tileId);
-    void destroyUnit(std::string const& unitId);
-    void repairUnit(std::string const& unitId, int newHealth);
-    void buildUnit(std::string const& tileId, std::string const& unitId);
-    void regenerateCapturePointsTile(std::string const& tileId, int newCapturePoints);
-    void produceFundsTile(std::string const& tileId);
+    void moveUnit(UnitId unitId, TileId tileId, Path const& path);
+    void waitUnit(UnitId unitId);
+    void attackUnit(UnitId attackerId, UnitId targetId, int damage);
+    void counterattackUnit(UnitId attackerId, UnitId targetId, int damage);
+    void captureTile(UnitId unitId, TileId tileId, int left);
+    void capturedTile(UnitId unitId, TileId tileId);
+    void deployUnit(UnitId unitId);
+    void undeployUnit(UnitId unitId);
+    void loadUnit(UnitId unitId, UnitId carrierId);
+    void unloadUnit(UnitId unitId, UnitId carrierId, TileId tileId);
+    void destroyUnit(UnitId unitId);
+    void repairUnit(UnitId unitId, int newHealth);
+    void buildUnit(TileId tileId, UnitId unitId);
+    void regenerateCapturePointsTile(TileId tileId, int newCapturePoints);
+    void produceFundsTile(TileId tileId);
     void beginTurn(int playerNumber);
     void endTurn(int playerNumber);
     void turnTimeout(int playerNumber);
     void finished(int winnerPlayerNumber);
     void surrender(int playerNumber);
 
+    // While a mark is open the event handlers record the values they
+    // overwrite. rollback reverts everything since the mark, commit keeps it.
+    // Marks nest and are closed in reverse order, closing any other mark
+    // throws std::logic_error. A rollback that reverted anything pushes a
+    // ROLLBACK event after the state is reverted and a change set of what it
+    // reverted. setGameDataFromJSON closes all marks.
+    JournalMark mark();
+    void rollback(JournalMark position);
+    void commit(JournalMark position);
 
-    Tile const& getTile(std::string const& tileId) const;
-    Unit const& getUnit(std::string const& unitId) const;
+    // Collects the changes of all events until the matching commitBatch into
+    // a single change set. Batches nest.
+    void beginBatch();
+    void commitBatch();
+
+    Tile getTile(TileId tileId) const;
+    Unit getUnit(UnitId unitId) const;
     Player const& getPlayer(int playerNumber) const;
 
-    std::unordered_map<std::string, Tile> const& getTiles() const;
-    std::unordered_map<std::string, Unit> const& getUnits() const;
+    TileStore const& getTiles() const;
+    UnitStore const& getUnits() const;
     std::unordered_map<int, Player> const& getPlayers() const;
     Rules const& getRules() const;
+    DamageTable const& getDamageTable() const;
+    RuleTables const& getRuleTables() const;
+    IdTable const& getTileIds() const;
+    IdTable const& getUnitIds() const;
 
     Player const& getInTurn();
-    Tile const* getTileAt(int x, int y) const;
+    int getInTurnNumber() const;
+    State getState() const;
+    TileId getTileAt(int x, int y) const;
+    UnitId getUnitAt(int x, int y) const;
+
+    // Maintained indexes in no particular order, empty for unknown keys
+    std::vector<UnitId> const& getUnitsOwnedBy(int playerNumber) const;
+    std::vector<TileId> const& getTilesOwnedBy(int playerNumber) const;
+    std::vector<TileId> const& getTilesOfType(int terrainId) const;
+
+    // Maintained bitboards over the map bounds, tiles are set by position
+    // and positions without a tile never are. Unknown players get an empty
+    // board, movement type IDs past the last throw std::out_of_range.
+    Bitboard const& getOccupiedBoard() const;
+    Bitboard const& getOwnerBoard(int playerNumber) const;
+    // Tiles units of the movement type can enter, ignoring units on them
+    Bitboard const& getPassableBoard(int movementTypeId) const;
+
+    // Calls f(tileId, distance) for each tile between minRange and maxRange
+    // hexes from center, ring by ring outwards
+    template<typename F>
+    void forEachTileInRange(Coordinates const& center, int minRange, int maxRange, F f) const;
+    // Calls f(coordinates) for each neighbouring position, tile or not
+    template<typename F>
+    void forEachNeighbor(Coordinates const& pos, F f) const;
 
     std::string const& getGameId() const;
 
     int calculateDistance(Coordinates const& a, Coordinates const& b) const;
+    // calculateDistance from origin to count packed positions, vectorized
+    // with SSE2/AVX2 when available. xs and ys can be TileStore columns.
+    void calculateDistances(Coordinates const& origin, int const* xs, int const* ys, int* distances,
+                            std::size_t count) const;
+    // Distances from numOrigins packed positions to count packed positions,
+    // distances[i * count + j] is from origin i to position j
+    void calculateDistanceMatrix(int const* originXs, int const* originYs, std::size_t numOrigins,
+                                 int const* xs, int const* ys, std::size_t count, int* distances) const;
     bool areAllies(int playerNumber1, int playerNumber2) const;
     Path findShortestPath(Coordinates const& a, Coordinates const& b) const;
-    Path findUnitPath(std::string const& unitId, Coordinates const& destination) const;
+    Path findUnitPath(UnitId unitId, Coordinates const& destination) const;
     std::vector<Coordinates> neighborCoordinates(Coordinates const& pos) const;
-    std::vector<Coordinates> findMovementOptions(std::string const& unitId) const;
+    std::vector<Coordinates> findMovementOptions(UnitId unitId) const;
+    MovementOptionSet findAllMovementOptions(int playerNumber) const;
+    // findMovementOptions as a bitboard over the map bounds
+    Bitboard findReachableBoard(UnitId unitId) const;
+    // Shared with the cache, stays valid after the cache drops it
+    std::shared_ptr<DistanceField const> getDistanceField(int movementTypeId, TileId targetId, int playerNumber) const;
+    Path findFieldPath(UnitId unitId, Coordinates const& destination) const;
     int calculateWeaponPower(Weapon const& weapon, int armorId, int distance) const;
     int calculateAttackDamage(UnitType const& attackerType, int attackerHealth, bool attackerDeployed, UnitType const& targetType, int targetHealth, int distance, int targetTerrainId) const;
-    std::unordered_map<std::string, int> findAttackOptions(std::string const& unitId, Coordinates const& position) const;
+    // Batched damage formula over packed arrays, power and defense come from
+    // getDamageTable(). Writes -1 where power is negative.
+    void calculateAttackDamages(int const* attackerHealth, int const* targetHealth, int const* power,
+                                int const* defense, int* damage, std::size_t count) const;
+    std::unordered_map<UnitId, int> findAttackOptions(UnitId unitId, Coordinates const& position) const;
 
   private:
+    friend class EventLog;
     static std::unordered_map<std::string, State> const STATE_NAMES;
 
-    std::string updateTileFromJSON(json::Value const& value);
-    std::string updateUnitFromJSON(json::Value const& value);
+    TileId updateTileFromJSON(json::Value const& value);
+    UnitId updateUnitFromJSON(json::Value const& value);
     int updatePlayerFromJSON(json::Value const& value);
 
+    void buildGridIndex();
+    int gridIndex(int x, int y) const;
+    void buildIndexes();
+    void indexUnit(UnitId unitId);
+    void indexTileOwner(TileId tileId);
+    void buildPassableBoards();
+    void setTileUnit(TileId tileId, UnitId unitId);
+    void buildAdjacency();
+    // Per search buffers, costs are all -1 between searches
+    struct MovementScratch
+    {
+      std::vector<int> costs;
+      std::vector<std::vector<TileId>> buckets;
+      std::vector<TileId> reached;
+      Bitboard reachedBoard; // Empty between searches
+      Bitboard blockedBoard;
+    };
+    void computeMovementOptions(UnitId unitId, MovementScratch& scratch, std::vector<TileId>& result) const;
+    void floodMovementOptions(UnitId unitId, MovementScratch& scratch, std::vector<TileId>& result) const;
+    void invalidateMovementOptionsNear(TileId tileId);
+    void invalidateDistanceFields(TileId tileId);
+    void occupancyChanged(TileId tileId);
+    int movementCost(int movementTypeId, int playerNumber, TileId tileId) const;
+
+    enum class JournalField : std::uint8_t
+    {
+      TILE_OWNER, TILE_UNIT, TILE_CAPTURE_POINTS, TILE_BEING_CAPTURED,
+      UNIT_TILE, UNIT_TYPE, UNIT_OWNER, UNIT_HEALTH, UNIT_CARRIED_BY, UNIT_FLAGS,
+      UNIT_MOVED_TURN, UNIT_CARRIED_UNITS, IN_TURN_NUMBER, TURN_GENERATION, STATE
+    };
+    struct JournalEntry
+    {
+      JournalField field;
+      std::uint32_t index;
+      std::int64_t value; // Previous value, index to journalCarriedUnitLists for UNIT_CARRIED_UNITS
+    };
+    void journal(JournalField field, std::uint32_t index, std::int64_t value);
+    void journalCarriedUnits(UnitId unitId);
+    template<typename T>
+    void setField(JournalField field, std::vector<T>& column, std::uint32_t index, typename std::vector<T>::value_type value);
+    void revert(JournalEntry const& entry);
+    // Reverts and removes journal entries past position, then touches and
+    // announces what changed
+    void revertJournal(std::size_t position);
+    void closeMark();
+    void indexField(JournalField field, std::uint32_t index);
+    void setMoved(UnitId unitId);
+
+    void touchTile(TileId tileId);
+    void touchUnit(UnitId unitId);
+    void touchPlayer(int playerNumber);
+    void touchAll();
+    void changed();
+
+    class UniformCost;
+    class UnitMovementCost;
+    template<typename Policy>
+    Path findPath(TileId startId, TileId endId, Policy const& policy) const;
+
     std::string gameId;
     std::string authorId;
     std::string name;
@@ -270,13 +523,152 @@ namespace wars
     double turnLength;
     std::unordered_set<int> bannedUnits;
 
+    TileLayout tileLayout;
     Rules rules;
+    DamageTable damageTable;
+    RuleTables ruleTables;
 
-    std::unordered_map<std::string, Tile> tiles;
-    std::unordered_map<std::string, Unit> units;
+    IdTable tileIds;
+    IdTable unitIds;
+    TileStore tiles;
+    UnitStore units;
     std::unordered_map<int, Player> players;
 
+    // Dense coordinate index over the map bounds, NO_TILE/NO_UNIT for holes
+    int gridMinX;
+    int gridMinY;
+    int gridWidth;
+    int gridHeight;
+    std::vector<TileId> tileGrid;
+    std::vector<UnitId> unitGrid;
+
+    // Handles grouped by a small non-negative key, each handle in at most
+    // one group. Removal swaps with the last handle of the group.
+    struct GroupIndex
+    {
+      std::vector<std::vector<Handle>> groups;
+      std::vector<int> keys; // Group of each handle, -1 for none
+      std::vector<std::uint32_t> positions; // Position of each handle in its group
+
+      void set(Handle handle, int key);
+      std::vector<Handle> const& get(int key) const;
+      void clear();
+    };
+    GroupIndex unitsByOwner; // Alive units only
+    GroupIndex tilesByOwner;
+    GroupIndex tilesByType;
+
+    // Bit n of allianceMasks[m] is set when players m and n are allies,
+    // rows of unknown players are 0. Covers player numbers below 64.
+    std::vector<std::uint64_t> allianceMasks;
+
+    // Bitboards over the grid index bounds
+    Bitboard occupiedBoard;
+    std::vector<Bitboard> ownerBoards; // [player number]
+    std::vector<Bitboard> passableBoards; // [movement type]
+    Bitboard emptyBoard;
+
+    // Hex neighbours of each tile in CSR form, neighbours of tile i are
+    // adjacency[adjacencyOffsets[i]] .. adjacency[adjacencyOffsets[i + 1] - 1]
+    std::vector<std::uint32_t> adjacencyOffsets;
+    std::vector<TileId> adjacency;
+
+    // findMovementOptions results indexed by UnitId. An entry is dropped when
+    // a unit enters or leaves a tile within radius of its origin.
+    struct MovementOptionsCache
+    {
+      MovementOptionsCache() : options(), origin(NO_TILE), radius(0), valid(false) {}
+
+      std::vector<Coordinates> options;
+      TileId origin;
+      int radius;
+      bool valid;
+    };
+    mutable std::vector<MovementOptionsCache> movementOptionsCache;
+    mutable MovementScratch movementScratch;
+    mutable std::unique_ptr<WorkerPool> workerPool;
+    // One per worker of workerPool, kept between queries like movementScratch
+    mutable std::vector<MovementScratch> workerScratches;
+
+    // Distance fields by (movement type, target, player), the least recently
+    // used one is dropped to stay within MAX_DISTANCE_FIELDS
+    static const std::size_t MAX_DISTANCE_FIELDS = 32;
+    typedef std::tuple<int, TileId, int> DistanceFieldKey;
+    struct CachedDistanceField
+    {
+      std::shared_ptr<DistanceField const> field;
+      std::uint64_t lastUse;
+    };
+    mutable std::map<DistanceFieldKey, CachedDistanceField> distanceFields;
+    mutable std::uint64_t distanceFieldUses;
+
+    // Scratch buffers reused by findPath, makes path queries non-reentrant
+    mutable AStar pathSearch;
+
+    // Overwritten values in change order, recorded while a mark is open
+    std::vector<JournalEntry> journalEntries;
+    std::vector<std::vector<UnitId>> journalCarriedUnitLists;
+    std::vector<JournalMark> journalMarks; // Open marks, innermost last
+    // Handles reverted by the last revertJournal, for the ROLLBACK event
+    std::vector<TileId> revertedTileIds;
+    std::vector<UnitId> revertedUnitIds;
+
+    // Pending change set, the touched flags are cleared when it is pushed
+    ChangeSet pendingChanges;
+    std::vector<std::uint8_t> tileTouched;
+    std::vector<std::uint8_t> unitTouched;
+    int batchDepth;
+    // Above 0 while a handler runs other handlers, the events they push are
+    // part of the outer event and replaying it pushes them again
+    int eventDepth;
+
     Stream<Event> eventStream;
+    Stream<ChangeSet> changeStream;
   };
 }
+
+inline int wars::Game::calculateDistance(Coordinates const& a, Coordinates const& b) const
+{
+  return Topology::distance(b.x - a.x, b.y - a.y);
+}
+
+template<typename F>
+void wars::Game::forEachTileInRange(Coordinates const& center, int minRange, int maxRange, F f) const
+{
+  for(int radius = std::max(minRange, 0); radius <= maxRange; ++radius)
+  {
+    if(radius == 0)
+    {
+      TileId tileId = getTileAt(center.x, center.y);
+      if(tileId != NO_TILE)
+        f(tileId, 0);
+      continue;
+    }
+
+    // Each side of a ring runs along one direction
+    int x = center.x + Topology::RING_START[0] * radius;
+    int y = center.y + Topology::RING_START[1] * radius;
+    for(auto const& direction : Topology::DIRECTIONS)
+    {
+      for(int step = 0; step < radius; ++step)
+      {
+        TileId tileId = getTileAt(x, y);
+        if(tileId != NO_TILE)
+          f(tileId, radius);
+        x += direction[0];
+        y += direction[1];
+      }
+    }
+  }
+}
+
+template<typename F>
+void wars::Game::forEachNeighbor(Coordinates const& pos, F f) const
+{
+  for(auto const& direction : Topology::DIRECTIONS)
+  {
+    f(Coordinates{pos.x + direction[0], pos.y + direction[1]});
+  }
+}
+
 #endif // WARS_GAME_H
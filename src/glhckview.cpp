@@ -95,150 +95,45 @@ wars::GlhckView::~GlhckView()
 void wars::GlhckView::setGame(Game* game)
 {
   _game = game;
+  _threats.reset(new ThreatMap(*game));
 
-  eventSub = _game->events().on([this](wars::Game::Event const& e) {
-    switch(e.type)
+  changeSub = _game->changes().on([this](wars::Game::ChangeSet const& changes) {
+    if(changes.reset)
     {
-      case wars::Game::EventType::GAMEDATA:
-      {
-        initializeFromGame();
-        updateFunds();
-        break;
-      }
-      case wars::Game::EventType::MOVE:
-      {
-        wars::Game::Unit const& unit = _game->getUnit(*e.move.unitId);
-        wars::Game::Tile const& next = _game->getTile(*e.move.tileId);
-        wars::Game::Tile const& prev = _game->getTile(unit.tileId);
-        glhckObject* o = _units.at(unit.id).obj;
-        kmVec3 pos = hexToRect({static_cast<kmScalar>(next.x), static_cast<kmScalar>(next.y), 1});
-        glhckObjectPositionf(o, pos.x, pos.y, pos.z);
-        break;
-      }
-      case wars::Game::EventType::WAIT:
-      {
-        wars::Game::Unit const& unit = _game->getUnit(*e.wait.unitId);
-        wars::Game::Tile const& curr = _game->getTile(unit.tileId);
-        break;
-      }
-      case wars::Game::EventType::ATTACK:
-      {
-        wars::Game::Unit const& attacker = _game->getUnit(*e.attack.attackerId);
-        wars::Game::Unit const& target = _game->getUnit(*e.attack.targetId);
-        break;
-      }
-      case wars::Game::EventType::COUNTERATTACK:
-      {
-        wars::Game::Unit const& attacker = _game->getUnit(*e.counterattack.attackerId);
-        wars::Game::Unit const& target = _game->getUnit(*e.counterattack.targetId);
-        break;
-      }
-      case wars::Game::EventType::CAPTURE:
-      {
-        wars::Game::Unit const& unit = _game->getUnit(*e.capture.unitId);
-        wars::Game::Tile const& tile = _game->getTile(*e.capture.tileId);
-        break;
-      }
-      case wars::Game::EventType::CAPTURED:
-      {
-        wars::Game::Unit const& unit = _game->getUnit(*e.captured.unitId);
-        wars::Game::Tile const& tile = _game->getTile(*e.captured.tileId);
-        break;
-      }
-      case wars::Game::EventType::DEPLOY:
-      {
-        wars::Game::Unit const& unit = _game->getUnit(*e.deploy.unitId);
-        wars::Game::Tile const& curr = _game->getTile(unit.tileId);
-        break;
-      }
-      case wars::Game::EventType::UNDEPLOY:
-      {
-        wars::Game::Unit const& unit = _game->getUnit(*e.undeploy.unitId);
-        wars::Game::Tile const& curr = _game->getTile(unit.tileId);
-        break;
-      }
-      case wars::Game::EventType::LOAD:
-      {
-        wars::Game::Unit const& unit = _game->getUnit(*e.load.unitId);
-        wars::Game::Unit const& carrier = _game->getUnit(*e.load.carrierId);
-        wars::Game::Tile const& curr = _game->getTile(unit.tileId);
-        glhckObject* o = _units.at(unit.id).obj;
-        _units.erase(unit.id);
-        glhckObjectFree(o);
-        break;
-      }
-      case wars::Game::EventType::UNLOAD:
-      {
-        wars::Game::Unit const& unit = _game->getUnit(*e.unload.unitId);
-        wars::Game::Unit const& carrier = _game->getUnit(*e.unload.carrierId);
-        wars::Game::Tile const& next = _game->getTile(*e.unload.tileId);
-        glhckObject* unitObject = createUnitObject(unit);
-        _units[unit.id] = {unit.id, unitObject};
-        kmVec3 pos = hexToRect({static_cast<kmScalar>(next.x), static_cast<kmScalar>(next.y), 1});
-        glhckObjectPositionf(unitObject, pos.x, pos.y, pos.z);
-        break;
-      }
-      case wars::Game::EventType::DESTROY:
-      {
-        wars::Game::Unit const& unit = _game->getUnit(*e.destroy.unitId);
-        wars::Game::Tile const& curr = _game->getTile(unit.tileId);
-        glhckObject* o = _units.at(unit.id).obj;
-        _units.erase(unit.id);
-        glhckObjectFree(o);
-        break;
-      }
-      case wars::Game::EventType::REPAIR:
+      initializeFromGame();
+      updateFunds();
+      return;
+    }
+
+    Game::UnitStore const& units = _game->getUnits();
+    for(Game::UnitId unitId : changes.unitIds)
+    {
+      auto iter = _units.find(unitId);
+      if(!units.exists(unitId) || units.tileId[unitId] == Game::NO_TILE)
       {
-        wars::Game::Unit const& unit = _game->getUnit(*e.repair.unitId);
-        wars::Game::Tile const& curr = _game->getTile(unit.tileId);
-        break;
+        // Destroyed or loaded into a carrier
+        if(iter != _units.end())
+        {
+          glhckObjectFree(iter->second.obj);
+          _units.erase(iter);
+        }
       }
-      case wars::Game::EventType::BUILD:
+      else if(iter == _units.end())
       {
-        updateFunds();
-        wars::Game::Unit const& unit = _game->getUnit(*e.build.unitId);
-        wars::Game::Tile const& tile = _game->getTile(*e.build.tileId);
-        glhckObject* unitObject = createUnitObject(unit);
+        glhckObject* unitObject = createUnitObject(_game->getUnit(unitId));
         if(unitObject != nullptr)
-          _units[unit.id] = {unit.id, unitObject};
-        break;
-      }
-      case wars::Game::EventType::REGENERATE_CAPTURE_POINTS:
-      {
-        wars::Game::Tile const& tile = _game->getTile(*e.regenerateCapturePoints.tileId);
-        break;
+          _units[unitId] = {unitId, unitObject};
       }
-      case wars::Game::EventType::PRODUCE_FUNDS:
-      {
-        wars::Game::Tile const& tile = _game->getTile(*e.produceFunds.tileId);
-        break;
-      }
-      case wars::Game::EventType::BEGIN_TURN:
-      {
-        updateFunds();
-        break;
-      }
-      case wars::Game::EventType::END_TURN:
-      {
-        break;
-      }
-      case wars::Game::EventType::TURN_TIMEOUT:
-      {
-        break;
-      }
-      case wars::Game::EventType::FINISHED:
-      {
-        break;
-      }
-      case wars::Game::EventType::SURRENDER:
-      {
-        break;
-      }
-      default:
+      else
       {
-        break;
+        wars::Game::Tile const& tile = _game->getTile(units.tileId[unitId]);
+        kmVec3 pos = hexToRect({static_cast<kmScalar>(tile.x()), static_cast<kmScalar>(tile.y()), 1});
+        glhckObjectPositionf(iter->second.obj, pos.x, pos.y, pos.z);
       }
     }
+
+    if(!changes.playerNumbers.empty())
+      updateFunds();
   });
 }
 
@@ -251,16 +146,18 @@ bool wars::GlhckView::handle()
   glhckCameraUpdate(_camera);
 
   bool tilesHighlighted = false;
+  bool tilesThreatened = false;
   for(auto& item : _tiles)
   {
     Game::Tile const& tile = _game->getTile(item.first);
 
-    bool selected = tile.x == _inputState.hexCursor.x
-        && tile.y == _inputState.hexCursor.y;
+    bool selected = tile.x() == _inputState.hexCursor.x
+        && tile.y() == _inputState.hexCursor.y;
     glhckObjectDrawAABB(item.second.hex, selected);
     glhckObjectDraw(item.second.hex);
 
     tilesHighlighted |= item.second.effects.highlight;
+    tilesThreatened |= item.second.effects.threatened;
 
     if(item.second.prop != nullptr)
       glhckObjectDraw(item.second.prop);
@@ -277,6 +174,20 @@ bool wars::GlhckView::handle()
   glhckRenderClear(GLHCK_DEPTH_BUFFER_BIT | GLHCK_COLOR_BUFFER_BIT);
   glhckRender();
 
+  if(tilesThreatened)
+  {
+    // Multiplying the tiles by their own color darkens them
+    glhckRenderBlendFunc(GLHCK_DST_COLOR, GLHCK_ZERO);
+    for(auto& item : _tiles)
+    {
+      if(item.second.effects.threatened)
+        glhckObjectDraw(item.second.hex);
+    }
+
+    glhckRender();
+    glhckRenderBlendFunc(GLHCK_ZERO, GLHCK_ZERO);
+  }
+
   if(tilesHighlighted)
   {
     glhckRenderBlendFunc(GLHCK_ONE, GLHCK_ONE);
@@ -376,25 +287,26 @@ void wars::GlhckView::initializeFromGame()
 {
   clear();
 
-  std::unordered_map<std::string, Game::Tile> const& tiles = _game->getTiles();
-  std::unordered_map<std::string, Game::Unit> const& units = _game->getUnits();
+  Game::TileStore const& tiles = _game->getTiles();
+  Game::UnitStore const& units = _game->getUnits();
   Rules const& rules = _game->getRules();
 
-  for(auto item : tiles)
+  for(Game::TileId tileId = 0; tileId < tiles.size(); ++tileId)
   {
-    _tiles[item.first] = {
-      item.first,
-      createTileHex(item.second),
-      createTileProp(item.second)
+    Game::Tile const tile = _game->getTile(tileId);
+    _tiles[tileId] = {
+      tileId,
+      createTileHex(tile),
+      createTileProp(tile)
     };
   }
 
-  for(auto item : units)
+  for(Game::UnitId unitId = 0; unitId < units.size(); ++unitId)
   {
-    if(!item.second.tileId.empty())
+    if(units.exists(unitId) && units.tileId[unitId] != Game::NO_TILE)
     {
-      glhckObject* unitObject = createUnitObject(item.second);
-      _units[item.first] = {item.first, unitObject};
+      glhckObject* unitObject = createUnitObject(_game->getUnit(unitId));
+      _units[unitId] = {unitId, unitObject};
     }
   }
 
@@ -567,44 +479,42 @@ void wars::GlhckView::handleClick()
     {
       if(inTurn.isMe)
       {
-        Game::Tile const* tile = _game->getTileAt(_inputState.hexCursor.x,
-                                                  _inputState.hexCursor.y);
+        Game::TileId tileId = _game->getTileAt(_inputState.hexCursor.x,
+                                               _inputState.hexCursor.y);
         Rules const& rules = _game->getRules();
 
-        if(tile != nullptr)
+        if(tileId != Game::NO_TILE)
         {
-          if(tile->unitId.empty())
+          Game::Tile const tile = _game->getTile(tileId);
+          if(tile.unitId() == Game::NO_UNIT)
           {
-            TerrainType const& terrain = rules.terrainTypes.at(tile->type);
-            if(tile->owner == inTurn.playerNumber
-               && !terrain.buildTypes.empty())
+            std::vector<int> const& buildableUnits = _game->getRuleTables().buildableUnits(tile.type());
+            if(tile.owner() == inTurn.playerNumber
+               && !buildableUnits.empty())
             {
-              _inputState.selected.tileId = tile->id;
+              _inputState.selected.tileId = tile.id();
               _phase = Phase::BUILD;
 
               _menu.clear();
-              for(auto const& item : rules.unitTypes)
+              for(int unitTypeId : buildableUnits)
               {
-                UnitType const& t = item.second;
-                if(terrain.buildTypes.find(t.unitClass) != terrain.buildTypes.end())
-                {
-                  _menu.addOption(t.id, t.name, t.id);
-                }
+                UnitType const& t = rules.unitTypes.at(unitTypeId);
+                _menu.addOption(t.id, t.name, t.id);
               }
               _menu.update();
             }
           }
           else
           {
-            Game::Unit const& unit = _game->getUnit(tile->unitId);
-            if(unit.owner == inTurn.playerNumber && !unit.moved)
+            Game::Unit const& unit = _game->getUnit(_game->getUnitAt(tile.x(), tile.y()));
+            if(unit.owner() == inTurn.playerNumber && !unit.moved())
             {
-              _inputState.selected.unitId = unit.id;
-              _inputState.hexOptions = _game->findMovementOptions(unit.id);
-              if(unit.deployed || _inputState.hexOptions.size() <= 1)
+              _inputState.selected.unitId = unit.id();
+              _inputState.hexOptions = _game->findReachableBoard(unit.id());
+              if(unit.deployed() || _inputState.hexOptions.count() <= 1)
               {
                 _phase = Phase::ACTION;
-                _inputState.selected.tileId = tile->id;
+                _inputState.selected.tileId = tile.id();
                 initializeActionMenu();
 
               }
@@ -615,9 +525,9 @@ void wars::GlhckView::handleClick()
                 for(auto& item : _tiles)
                 {
                   Game::Tile const& t = _game->getTile(item.first);
-                  Game::Coordinates c = {t.x, t.y};
-                  item.second.effects.highlight = std::find(_inputState.hexOptions.begin(), _inputState.hexOptions.end(), c) != _inputState.hexOptions.end();
+                  item.second.effects.highlight = _inputState.hexOptions.contains(t.x(), t.y());
                 }
+                shadeThreatenedTiles(unit.owner());
               }
             }
           }
@@ -636,12 +546,12 @@ void wars::GlhckView::handleClick()
       for(auto& item : _tiles)
       {
         item.second.effects.highlight = false;
+        item.second.effects.threatened = false;
       }
 
-      Game::Coordinates coords = {_inputState.hexCursor.x, _inputState.hexCursor.y};
-      if(std::find(_inputState.hexOptions.begin(), _inputState.hexOptions.end(), coords) != _inputState.hexOptions.end())
+      if(_inputState.hexOptions.contains(_inputState.hexCursor.x, _inputState.hexCursor.y))
       {
-        _inputState.selected.tileId = _game->getTileAt(_inputState.hexCursor.x, _inputState.hexCursor.y)->id;
+        _inputState.selected.tileId = _game->getTileAt(_inputState.hexCursor.x, _inputState.hexCursor.y);
         _phase = Phase::ACTION;
         initializeActionMenu();
       }
@@ -654,16 +564,16 @@ void wars::GlhckView::handleClick()
 
     case Phase::ATTACK:
     {
-      Game::Tile const* enemyTile = _game->getTileAt(_inputState.hexCursor.x, _inputState.hexCursor.y);
-      if(enemyTile->unitId.empty() || _inputState.attackOptions.find(enemyTile->unitId) == _inputState.attackOptions.end())
+      Game::UnitId enemyId = _game->getUnitAt(_inputState.hexCursor.x, _inputState.hexCursor.y);
+      if(enemyId == Game::NO_UNIT || _inputState.attackOptions.find(enemyId) == _inputState.attackOptions.end())
       {
         _phase = Phase::SELECT;
       }
       else
       {
-        Game::Unit const& enemyUnit = _game->getUnit(enemyTile->unitId);
+        Game::Unit const& enemyUnit = _game->getUnit(enemyId);
         Game::Tile const& tile = _game->getTile(_inputState.selected.tileId);
-        Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x, tile.y});
+        Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x(), tile.y()});
         if(path.empty())
         {
           // Cannot move to location
@@ -672,7 +582,7 @@ void wars::GlhckView::handleClick()
         else
         {
           _phase = Phase::WAIT;
-          _input->moveAttack(_game->getGameId(), _inputState.selected.unitId, enemyUnit.id, {tile.x, tile.y}, convertPath(path)).then<void>([this](bool success) {
+          _input->moveAttack(_game->getGameId(), _inputState.selected.unitId, enemyUnit.id(), {tile.x(), tile.y()}, convertPath(path)).then<void>([this](bool success) {
             std::cout << "moveAttack " << (success ? "SUCCESS" : "FAILURE") << std::endl;
             _phase = Phase::SELECT;
           });
@@ -684,6 +594,11 @@ void wars::GlhckView::handleClick()
         item.second.effects.highlight = false;
       }
 
+      for(auto& item : _tiles)
+      {
+        item.second.effects.threatened = false;
+      }
+
       break;
     }
 
@@ -735,7 +650,7 @@ void wars::GlhckView::handleKey(int key)
           case Action::WAIT:
           {
             Game::Tile const& tile = _game->getTile(_inputState.selected.tileId);
-            Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x, tile.y});
+            Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x(), tile.y()});
             if(path.empty())
             {
               // Cannot move to location
@@ -744,7 +659,7 @@ void wars::GlhckView::handleKey(int key)
             else
             {
               _phase = Phase::WAIT;
-              _input->moveWait(_game->getGameId(), _inputState.selected.unitId, {tile.x, tile.y}, convertPath(path)).then<void>([this](bool success) {
+              _input->moveWait(_game->getGameId(), _inputState.selected.unitId, {tile.x(), tile.y()}, convertPath(path)).then<void>([this](bool success) {
                 std::cout << "moveWait " << (success ? "SUCCESS" : "FAILURE") << std::endl;
                 _phase = Phase::SELECT;
               });
@@ -756,22 +671,23 @@ void wars::GlhckView::handleKey(int key)
           {
             _phase = Phase::ATTACK;
             Game::Tile const& tile = _game->getTile(_inputState.selected.tileId);
-            _inputState.attackOptions = _game->findAttackOptions(_inputState.selected.unitId, {tile.x, tile.y});
+            _inputState.attackOptions = _game->findAttackOptions(_inputState.selected.unitId, {tile.x(), tile.y()});
             std::cout << "Attack options:" << std::endl;
             for(auto const& o : _inputState.attackOptions)
-              std::cout << o.first << ": " << o.second << std::endl;
+              std::cout << _game->getUnitIds().str(o.first) << ": " << o.second << std::endl;
 
             for(auto& item : _units)
             {
               item.second.effects.highlight = _inputState.attackOptions.find(item.first) != _inputState.attackOptions.end();
             }
+            shadeThreatenedTiles(inTurn.playerNumber);
 
             break;
           }
           case Action::CAPTURE:
           {
             Game::Tile const& tile = _game->getTile(_inputState.selected.tileId);
-            Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x, tile.y});
+            Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x(), tile.y()});
             if(path.empty())
             {
               // Cannot move to location
@@ -780,7 +696,7 @@ void wars::GlhckView::handleKey(int key)
             else
             {
               _phase = Phase::WAIT;
-              _input->moveCapture(_game->getGameId(), _inputState.selected.unitId, {tile.x, tile.y}, convertPath(path)).then<void>([this](bool success) {
+              _input->moveCapture(_game->getGameId(), _inputState.selected.unitId, {tile.x(), tile.y()}, convertPath(path)).then<void>([this](bool success) {
                 std::cout << "moveCapture " << (success ? "SUCCESS" : "FAILURE") << std::endl;
                 _phase = Phase::SELECT;
               });
@@ -790,7 +706,7 @@ void wars::GlhckView::handleKey(int key)
           case Action::DEPLOY:
           {
             Game::Tile const& tile = _game->getTile(_inputState.selected.tileId);
-            Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x, tile.y});
+            Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x(), tile.y()});
             if(path.empty())
             {
               // Cannot move to location
@@ -799,7 +715,7 @@ void wars::GlhckView::handleKey(int key)
             else
             {
               _phase = Phase::WAIT;
-              _input->moveDeploy(_game->getGameId(), _inputState.selected.unitId, {tile.x, tile.y}, convertPath(path)).then<void>([this](bool success) {
+              _input->moveDeploy(_game->getGameId(), _inputState.selected.unitId, {tile.x(), tile.y()}, convertPath(path)).then<void>([this](bool success) {
                 std::cout << "moveDeploy " << (success ? "SUCCESS" : "FAILURE") << std::endl;
                 _phase = Phase::SELECT;
               });
@@ -818,7 +734,7 @@ void wars::GlhckView::handleKey(int key)
           case Action::LOAD:
           {
             Game::Tile const& tile = _game->getTile(_inputState.selected.tileId);
-            Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x, tile.y});
+            Game::Path path = _game->findUnitPath(_inputState.selected.unitId, {tile.x(), tile.y()});
             if(path.empty())
             {
               // Cannot move to location
@@ -838,7 +754,7 @@ void wars::GlhckView::handleKey(int key)
           case Action::UNLOAD:
           {
             Game::Unit const& unit = _game->getUnit(_inputState.selected.unitId);
-            if(unit.carriedUnits.empty())
+            if(unit.carriedUnits().empty())
             {
               _phase = Phase::SELECT;
             }
@@ -846,9 +762,9 @@ void wars::GlhckView::handleKey(int key)
             {
               _phase = Phase::UNLOAD_UNIT;
               _menu.clear();
-              for(int i = 0; i < unit.carriedUnits.size(); ++i)
+              for(int i = 0; i < unit.carriedUnits().size(); ++i)
               {
-                _menu.addOption(i, unit.carriedUnits.at(i), i);
+                _menu.addOption(i, _game->getUnitIds().str(unit.carriedUnits().at(i)), i);
               }
               _menu.update();
             }
@@ -894,7 +810,7 @@ void wars::GlhckView::handleKey(int key)
       {
         std::cout << "Build unit id " << result << std::endl;
         Game::Tile const& tile = _game->getTile(_inputState.selected.tileId);
-        _input->build(_game->getGameId(), {tile.x, tile.y}, result).then<void>([this](bool const& success) {
+        _input->build(_game->getGameId(), {tile.x(), tile.y()}, result).then<void>([this](bool const& success) {
           _phase = Phase::SELECT;
           std::cout << "Build " << (success ? "SUCCESS" : "FAILURE") << std::endl;
         });
@@ -965,6 +881,24 @@ void wars::GlhckView::updateFunds()
   });
 }
 
+void wars::GlhckView::shadeThreatenedTiles(int playerNumber)
+{
+  // Tiles any enemy of playerNumber could strike next turn
+  for(auto& item : _tiles)
+  {
+    bool threatened = false;
+    for(auto const& player : _game->getPlayers())
+    {
+      if(!_game->areAllies(playerNumber, player.first) && _threats->damage(player.first, item.first) > 0)
+      {
+        threatened = true;
+        break;
+      }
+    }
+    item.second.effects.threatened = threatened;
+  }
+}
+
 wars::Input::Path wars::GlhckView::convertPath(const wars::Game::Path& path) const
 {
   Input::Path result;
@@ -980,10 +914,10 @@ glhckObject* wars::GlhckView::createUnitObject(const wars::Game::Unit& unit)
 {
   glhckObject* o = glhckCubeNew(1.0);
 
-  if(!unit.tileId.empty())
+  if(unit.tileId() != Game::NO_TILE)
   {
-    Game::Tile const& tile = _game->getTile(unit.tileId);
-    kmVec3 pos = hexToRect({static_cast<kmScalar>(tile.x), static_cast<kmScalar>(tile.y), 1.0f});
+    Game::Tile const& tile = _game->getTile(unit.tileId());
+    kmVec3 pos = hexToRect({static_cast<kmScalar>(tile.x()), static_cast<kmScalar>(tile.y()), 1.0f});
     glhckObjectPositionf(o, pos.x, pos.y, pos.z);
   }
   std::string const files[] = {
@@ -1008,10 +942,10 @@ glhckObject* wars::GlhckView::createUnitObject(const wars::Game::Unit& unit)
     "textures/ab_placeholder.png",
     "textures/cr_placeholder.png"
   };
-  glhckTexture* t = glhckTextureNewFromFile(files[unit.type].data(), glhckImportDefaultImageParameters(), glhckTextureDefaultSpriteParameters());
+  glhckTexture* t = glhckTextureNewFromFile(files[unit.type()].data(), glhckImportDefaultImageParameters(), glhckTextureDefaultSpriteParameters());
   glhckMaterial* m = glhckMaterialNew(t);
   glhckTextureFree(t);
-  glhckMaterialDiffuse(m, &_theme.playerColors[unit.owner]);
+  glhckMaterialDiffuse(m, &_theme.playerColors[unit.owner()]);
   glhckObjectMaterial(o, m);
   glhckMaterialFree(m);
   glhckObjectDrawOBB(o, 1);
@@ -1020,10 +954,10 @@ glhckObject* wars::GlhckView::createUnitObject(const wars::Game::Unit& unit)
 
 glhckObject* wars::GlhckView::createTileHex(const wars::Game::Tile& tile)
 {
-  TerrainType const& terrain = _game->getRules().terrainTypes.at(tile.type);
-  glhckObject* o = glhckModelNew(_theme.tiles[tile.type].model.data(), 1.0, glhckImportDefaultModelParameters());
-  kmVec3 pos = {static_cast<kmScalar>(tile.x), static_cast<kmScalar>(tile.y), 0};
-  kmVec3Add(&pos, &pos, &_theme.tiles[tile.type].offset);
+  TerrainType const& terrain = _game->getRules().terrainTypes.at(tile.type());
+  glhckObject* o = glhckModelNew(_theme.tiles[tile.type()].model.data(), 1.0, glhckImportDefaultModelParameters());
+  kmVec3 pos = {static_cast<kmScalar>(tile.x()), static_cast<kmScalar>(tile.y()), 0};
+  kmVec3Add(&pos, &pos, &_theme.tiles[tile.type()].offset);
   pos = hexToRect(pos);
   glhckObjectPositionf(o, pos.x, pos.y, pos.z);
   return o;
@@ -1031,15 +965,15 @@ glhckObject* wars::GlhckView::createTileHex(const wars::Game::Tile& tile)
 
 glhckObject*wars::GlhckView::createTileProp(const wars::Game::Tile& tile)
 {
-  TerrainType const& terrain = _game->getRules().terrainTypes.at(tile.type);
+  TerrainType const& terrain = _game->getRules().terrainTypes.at(tile.type());
   if(_theme.tiles[terrain.id].prop.model.empty())
     return nullptr;
 
   glhckObject* o = glhckModelNew(_theme.tiles[terrain.id].prop.model.data(), 1.0, glhckImportDefaultModelParameters());
 
-  if(_theme.tiles[terrain.id].prop.textures.size() > tile.owner)
+  if(_theme.tiles[terrain.id].prop.textures.size() > tile.owner())
   {
-    glhckTexture* texture = glhckTextureNewFromFile(_theme.tiles[terrain.id].prop.textures[tile.owner].data(),
+    glhckTexture* texture = glhckTextureNewFromFile(_theme.tiles[terrain.id].prop.textures[tile.owner()].data(),
         glhckImportDefaultImageParameters(), glhckTextureDefaultLinearParameters());
     glhckMaterial* m = glhckObjectGetMaterial(o);
     if(m == nullptr)
@@ -1055,8 +989,8 @@ glhckObject*wars::GlhckView::createTileProp(const wars::Game::Tile& tile)
     glhckTextureFree(texture);
   }
 
-  kmVec3 pos = {static_cast<kmScalar>(tile.x), static_cast<kmScalar>(tile.y), 0};
-  kmVec3Add(&pos, &pos, &_theme.tiles[tile.type].offset);
+  kmVec3 pos = {static_cast<kmScalar>(tile.x()), static_cast<kmScalar>(tile.y()), 0};
+  kmVec3Add(&pos, &pos, &_theme.tiles[tile.type()].offset);
   pos = hexToRect(pos);
   glhckObjectPositionf(o, pos.x, pos.y, pos.z);
   return o;
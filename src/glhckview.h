@@ -8,6 +8,7 @@
 #include "glfwhck.h"
 #include "jsonpp.h"
 #include "textmenu.h"
+#include "threatmap.h"
 
 #include <string>
 #include <unordered_map>
@@ -31,7 +32,7 @@ namespace wars
   private:
     struct Unit
     {
-      std::string id;
+      Game::UnitId id;
       glhckObject* obj;
       struct
       {
@@ -40,12 +41,13 @@ namespace wars
     };
     struct Tile
     {
-      std::string id;
+      Game::TileId id;
       glhckObject* hex;
       glhckObject* prop;
       struct
       {
         bool highlight = false;
+        bool threatened = false;
       } effects;
     };
     struct InputState
@@ -73,15 +75,15 @@ namespace wars
 
       struct
       {
-        std::string tileId = "";
-        std::string unitId = "";
-        std::string carrierId = "";
+        Game::TileId tileId = Game::NO_TILE;
+        Game::UnitId unitId = Game::NO_UNIT;
+        Game::UnitId carrierId = Game::NO_UNIT;
         int carriedIndex = 0;
       } selected;
 
       bool acceptInput = false;
-      std::vector<Game::Coordinates> hexOptions;
-      std::unordered_map<std::string, int> attackOptions;
+      Bitboard hexOptions;
+      std::unordered_map<Game::UnitId, int> attackOptions;
     };
 
     struct Theme
@@ -123,6 +125,7 @@ namespace wars
     void updateStatusText();
     void setStatusText(std::string const& str);
     void updateFunds();
+    void shadeThreatenedTiles(int playerNumber);
 
     Input::Path convertPath(Game::Path const& path) const;
 
@@ -134,15 +137,16 @@ namespace wars
 
     Input* _input;
     Game* _game;
-    Stream<wars::Game::Event>::Subscription eventSub;
+    Stream<wars::Game::ChangeSet>::Subscription changeSub;
+    std::unique_ptr<ThreatMap> _threats;
     GLFWwindow* _window;
     glhckCamera* _camera;
     glfwhckEventQueue* _glfwEvents;
 
     Theme _theme;
 
-    std::unordered_map<std::string, Unit> _units;
-    std::unordered_map<std::string, Tile> _tiles;
+    std::unordered_map<Game::UnitId, Unit> _units;
+    std::unordered_map<Game::TileId, Tile> _tiles;
 
     bool _shouldQuit;
     InputState _inputState;
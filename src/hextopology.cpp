@@ -0,0 +1,60 @@
+#include "hextopology.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Storage for the tables, they are used by address in loops
+constexpr int wars::AxialHex::DIRECTIONS[wars::AxialHex::NUM_DIRECTIONS][2];
+constexpr int wars::AxialHex::RING_START[2];
+constexpr int wars::AxialHex::NUM_DIRECTIONS;
+
+void wars::AxialHex::distances(int x, int y, int const* xs, int const* ys, int* result, std::size_t count)
+{
+  std::size_t i = 0;
+
+#if defined(__AVX2__)
+  __m256i const originX = _mm256_set1_epi32(x);
+  __m256i const originY = _mm256_set1_epi32(y);
+
+  for(; i + 8 <= count; i += 8)
+  {
+    __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(xs + i)), originX);
+    __m256i dy = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(ys + i)), originY);
+    __m256i d = _mm256_max_epi32(_mm256_max_epi32(_mm256_abs_epi32(dx), _mm256_abs_epi32(dy)),
+                                 _mm256_abs_epi32(_mm256_add_epi32(dx, dy)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), d);
+  }
+#elif defined(__SSE2__)
+  // SSE2 has no integer abs or max, both are built from shifts and compares
+  __m128i const originX = _mm_set1_epi32(x);
+  __m128i const originY = _mm_set1_epi32(y);
+
+  for(; i + 4 <= count; i += 4)
+  {
+    __m128i dx = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(xs + i)), originX);
+    __m128i dy = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(ys + i)), originY);
+    __m128i dz = _mm_add_epi32(dx, dy);
+
+    __m128i sign = _mm_srai_epi32(dx, 31);
+    dx = _mm_sub_epi32(_mm_xor_si128(dx, sign), sign);
+    sign = _mm_srai_epi32(dy, 31);
+    dy = _mm_sub_epi32(_mm_xor_si128(dy, sign), sign);
+    sign = _mm_srai_epi32(dz, 31);
+    dz = _mm_sub_epi32(_mm_xor_si128(dz, sign), sign);
+
+    __m128i greater = _mm_cmpgt_epi32(dx, dy);
+    __m128i d = _mm_or_si128(_mm_and_si128(greater, dx), _mm_andnot_si128(greater, dy));
+    greater = _mm_cmpgt_epi32(d, dz);
+    d = _mm_or_si128(_mm_and_si128(greater, d), _mm_andnot_si128(greater, dz));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), d);
+  }
+#endif
+
+  for(; i < count; ++i)
+  {
+    result[i] = distance(xs[i] - x, ys[i] - y);
+  }
+}
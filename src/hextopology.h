@@ -0,0 +1,56 @@
+#ifndef WARS_HEXTOPOLOGY_H
+#define WARS_HEXTOPOLOGY_H
+
+#include <cstddef>
+
+namespace wars
+{
+  // Hex map in axial coordinates. A topology is a set of compile time
+  // tables and constexpr functions, searches take it as a type so every
+  // step inlines to plain arithmetic:
+  //   NUM_DIRECTIONS  number of neighbours of a tile
+  //   DIRECTIONS      neighbour offsets, in ring walk order
+  //   RING_START      offset of the first tile of the radius 1 ring, a ring
+  //                   of radius r starts at r times it and walks r steps
+  //                   along each direction
+  //   distance(dx, dy), ringSize(radius)
+  //   distances(x, y, xs, ys, result, count)
+  //                   distance from (x, y) to count packed positions
+  struct AxialHex
+  {
+    static constexpr int NUM_DIRECTIONS = 6;
+    static constexpr int DIRECTIONS[NUM_DIRECTIONS][2] = {{1, 0}, {1, -1}, {0, -1}, {-1, 0}, {-1, 1}, {0, 1}};
+    static constexpr int RING_START[2] = {-1, 1};
+
+    static constexpr int distance(int dx, int dy)
+    {
+      // Branch free max(|dx|, |dy|, |dx + dy|)
+      return max(max(abs(dx), abs(dy)), abs(dx + dy));
+    }
+
+    static constexpr int ringSize(int radius)
+    {
+      return radius > 0 ? NUM_DIRECTIONS * radius : 1;
+    }
+
+    // Batched distance using SSE2/AVX2 when available, results are identical
+    // to distance
+    static void distances(int x, int y, int const* xs, int const* ys, int* result, std::size_t count);
+
+  private:
+    static constexpr int abs(int v)
+    {
+      return v < 0 ? -v : v;
+    }
+
+    static constexpr int max(int a, int b)
+    {
+      return a > b ? a : b;
+    }
+  };
+
+  static_assert(AxialHex::distance(3, -1) == 3 && AxialHex::distance(2, 2) == 4 && AxialHex::distance(-2, 1) == 2,
+                "Axial distance");
+}
+
+#endif // WARS_HEXTOPOLOGY_H
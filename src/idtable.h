@@ -0,0 +1,61 @@
+#ifndef WARS_IDTABLE_H
+#define WARS_IDTABLE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace wars
+{
+  typedef std::uint32_t Handle;
+  Handle const INVALID_HANDLE = 0xffffffff;
+
+  // Maps server string IDs to dense handles in order of first appearance
+  class IdTable
+  {
+  public:
+    IdTable() : handles(), ids()
+    {
+    }
+
+    Handle intern(std::string const& id)
+    {
+      auto iter = handles.find(id);
+      if(iter != handles.end())
+        return iter->second;
+
+      Handle handle = static_cast<Handle>(ids.size());
+      handles[id] = handle;
+      ids.push_back(id);
+      return handle;
+    }
+
+    Handle find(std::string const& id) const
+    {
+      auto iter = handles.find(id);
+      return iter != handles.end() ? iter->second : INVALID_HANDLE;
+    }
+
+    std::string const& str(Handle handle) const
+    {
+      return ids.at(handle);
+    }
+
+    std::size_t size() const
+    {
+      return ids.size();
+    }
+
+    void clear()
+    {
+      handles.clear();
+      ids.clear();
+    }
+
+  private:
+    std::unordered_map<std::string, Handle> handles;
+    std::vector<std::string> ids;
+  };
+}
+#endif // WARS_IDTABLE_H
@@ -2,6 +2,7 @@
 #define INPUT_H
 #include "stream.h"
 #include "promise.h"
+#include "game.h"
 #include <string>
 #include <vector>
 
@@ -28,7 +29,7 @@ namespace wars
     struct MoveWait
     {
       std::string gameId;
-      std::string unitId;
+      Game::UnitId unitId;
       Position destination;
       Path path;
       Promise<bool> result;
@@ -37,8 +38,8 @@ namespace wars
     struct MoveAttack
     {
       std::string gameId;
-      std::string unitId;
-      std::string targetId;
+      Game::UnitId unitId;
+      Game::UnitId targetId;
       Position destination;
       Path path;
       Promise<bool> result;
@@ -50,15 +51,15 @@ namespace wars
     struct Undeploy
     {
       std::string gameId;
-      std::string unitId;
+      Game::UnitId unitId;
       Promise<bool> result;
     };
 
     struct MoveLoad
     {
       std::string gameId;
-      std::string unitId;
-      std::string carrierId;
+      Game::UnitId unitId;
+      Game::UnitId carrierId;
       Path path;
       Promise<bool> result;
     };
@@ -66,10 +67,10 @@ namespace wars
     struct MoveUnload
     {
       std::string gameId;
-      std::string unitId;
+      Game::UnitId unitId;
       Position destination;
       Path path;
-      std::string carriedId;
+      Game::UnitId carriedId;
       Position unloadDestination;
       Promise<bool> result;
     };
@@ -113,43 +114,43 @@ namespace wars
       events.build.push({gameId, position, type, promise});
       return promise;
     }
-    Promise<bool> moveWait(std::string const& gameId, std::string const& unitId, Position destination, Path const& path)
+    Promise<bool> moveWait(std::string const& gameId, Game::UnitId unitId, Position destination, Path const& path)
     {
       Promise<bool> promise;
       events.moveWait.push({gameId, unitId, destination, path, promise});
       return promise;
     }
-    Promise<bool> moveAttack(std::string const& gameId, std::string const& unitId, std::string const& targetId, Position destination, Path const& path)
+    Promise<bool> moveAttack(std::string const& gameId, Game::UnitId unitId, Game::UnitId targetId, Position destination, Path const& path)
     {
       Promise<bool> promise;
       events.moveAttack.push({gameId, unitId, targetId, destination, path, promise});
       return promise;
     }
-    Promise<bool> moveDeploy(std::string const& gameId, std::string const& unitId, Position destination, Path const& path)
+    Promise<bool> moveDeploy(std::string const& gameId, Game::UnitId unitId, Position destination, Path const& path)
     {
       Promise<bool> promise;
       events.moveDeploy.push({gameId, unitId, destination, path, promise});
       return promise;
     }
-    Promise<bool> undeploy(std::string const& gameId, std::string const& unitId)
+    Promise<bool> undeploy(std::string const& gameId, Game::UnitId unitId)
     {
       Promise<bool> promise;
       events.undeploy.push({gameId, unitId, promise});
       return promise;
     }
-    Promise<bool> moveCapture(std::string const& gameId, std::string const& unitId, Position destination, Path const& path)
+    Promise<bool> moveCapture(std::string const& gameId, Game::UnitId unitId, Position destination, Path const& path)
     {
       Promise<bool> promise;
       events.moveCapture.push({gameId, unitId, destination, path, promise});
       return promise;
     }
-    Promise<bool> moveLoad(std::string const& gameId, std::string const& unitId, std::string const& carrierId, Path const& path)
+    Promise<bool> moveLoad(std::string const& gameId, Game::UnitId unitId, Game::UnitId carrierId, Path const& path)
     {
       Promise<bool> promise;
       events.moveLoad.push({gameId, unitId, carrierId, path, promise});
       return promise;
     }
-    Promise<bool> moveUnload(std::string const& gameId, std::string const& unitId, Position destination, Path const& path, std::string const& carriedId, Position carriedDestination)
+    Promise<bool> moveUnload(std::string const& gameId, Game::UnitId unitId, Position destination, Path const& path, Game::UnitId carriedId, Position carriedDestination)
     {
       Promise<bool> promise;
       events.moveUnload.push({gameId, unitId, destination, path, carriedId, carriedDestination, promise});
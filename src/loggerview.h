@@ -26,108 +26,108 @@ namespace wars
           }
           case wars::Game::EventType::MOVE:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.move.unitId);
-            wars::Game::Tile const& next = game->getTile(*e.move.tileId);
-            wars::Game::Tile const& prev = game->getTile(unit.tileId);
-            std::cout << "Unit " << unit.id << " moves from (" << prev.x << ", " << prev.y  << ") to (" << next.x << ", " << next.y << ")" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.move.unitId);
+            wars::Game::Tile const& next = game->getTile(e.move.tileId);
+            wars::Game::Tile const& prev = game->getTile(unit.tileId());
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " moves from (" << prev.x() << ", " << prev.y()  << ") to (" << next.x() << ", " << next.y() << ")" << std::endl;
             break;
           }
           case wars::Game::EventType::WAIT:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.wait.unitId);
-            wars::Game::Tile const& curr = game->getTile(unit.tileId);
-            std::cout << "Unit " << unit.id << " waits at (" << curr.x << ", " << curr.y  << ")" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.wait.unitId);
+            wars::Game::Tile const& curr = game->getTile(unit.tileId());
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " waits at (" << curr.x() << ", " << curr.y()  << ")" << std::endl;
             break;
           }
           case wars::Game::EventType::ATTACK:
           {
-            wars::Game::Unit const& attacker = game->getUnit(*e.attack.attackerId);
-            wars::Game::Unit const& target = game->getUnit(*e.attack.targetId);
-            std::cout << "Unit " << attacker.id << " attacks unit " << target.id << ", inflicts " << e.attack.damage  << " points damage" << std::endl;
+            wars::Game::Unit const& attacker = game->getUnit(e.attack.attackerId);
+            wars::Game::Unit const& target = game->getUnit(e.attack.targetId);
+            std::cout << "Unit " << game->getUnitIds().str(attacker.id()) << " attacks unit " << game->getUnitIds().str(target.id()) << ", inflicts " << e.attack.damage  << " points damage" << std::endl;
             break;
           }
           case wars::Game::EventType::COUNTERATTACK:
           {
-            wars::Game::Unit const& attacker = game->getUnit(*e.counterattack.attackerId);
-            wars::Game::Unit const& target = game->getUnit(*e.counterattack.targetId);
-            std::cout << "Unit " << attacker.id << " counterattacks unit " << target.id << ", inflicts " << e.counterattack.damage  << " points damage" << std::endl;
+            wars::Game::Unit const& attacker = game->getUnit(e.counterattack.attackerId);
+            wars::Game::Unit const& target = game->getUnit(e.counterattack.targetId);
+            std::cout << "Unit " << game->getUnitIds().str(attacker.id()) << " counterattacks unit " << game->getUnitIds().str(target.id()) << ", inflicts " << e.counterattack.damage  << " points damage" << std::endl;
             break;
           }
           case wars::Game::EventType::CAPTURE:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.capture.unitId);
-            wars::Game::Tile const& tile = game->getTile(*e.capture.tileId);
-            std::cout << "Unit " << unit.id << " captures tile at (" << tile.x << ", " << tile.y  << "), " << e.capture.left << " capture points left" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.capture.unitId);
+            wars::Game::Tile const& tile = game->getTile(e.capture.tileId);
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " captures tile at (" << tile.x() << ", " << tile.y()  << "), " << e.capture.left << " capture points left" << std::endl;
             break;
           }
           case wars::Game::EventType::CAPTURED:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.captured.unitId);
-            wars::Game::Tile const& tile = game->getTile(*e.captured.tileId);
-            std::cout << "Unit " << unit.id << " captured tile at (" << tile.x << ", " << tile.y  << ")" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.captured.unitId);
+            wars::Game::Tile const& tile = game->getTile(e.captured.tileId);
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " captured tile at (" << tile.x() << ", " << tile.y()  << ")" << std::endl;
             break;
           }
           case wars::Game::EventType::DEPLOY:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.deploy.unitId);
-            wars::Game::Tile const& curr = game->getTile(unit.tileId);
-            std::cout << "Unit " << unit.id << " deploys at (" << curr.x << ", " << curr.y  << ")" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.deploy.unitId);
+            wars::Game::Tile const& curr = game->getTile(unit.tileId());
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " deploys at (" << curr.x() << ", " << curr.y()  << ")" << std::endl;
             break;
           }
           case wars::Game::EventType::UNDEPLOY:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.undeploy.unitId);
-            wars::Game::Tile const& curr = game->getTile(unit.tileId);
-            std::cout << "Unit " << unit.id << " undeploys at (" << curr.x << ", " << curr.y  << ")" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.undeploy.unitId);
+            wars::Game::Tile const& curr = game->getTile(unit.tileId());
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " undeploys at (" << curr.x() << ", " << curr.y()  << ")" << std::endl;
             break;
           }
           case wars::Game::EventType::LOAD:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.load.unitId);
-            wars::Game::Unit const& carrier = game->getUnit(*e.load.carrierId);
-            wars::Game::Tile const& curr = game->getTile(unit.tileId);
-            std::cout << "Unit " << unit.id << " loads into unit " << carrier.id << " at (" << curr.x << ", " << curr.y  << ")" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.load.unitId);
+            wars::Game::Unit const& carrier = game->getUnit(e.load.carrierId);
+            wars::Game::Tile const& curr = game->getTile(unit.tileId());
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " loads into unit " << game->getUnitIds().str(carrier.id()) << " at (" << curr.x() << ", " << curr.y()  << ")" << std::endl;
             break;
           }
           case wars::Game::EventType::UNLOAD:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.unload.unitId);
-            wars::Game::Unit const& carrier = game->getUnit(*e.unload.carrierId);
-            wars::Game::Tile const& next = game->getTile(*e.unload.tileId);
-            std::cout << "Unit " << unit.id << " unloads from unit " << carrier.id << " to (" << next.x << ", " << next.y  << ")" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.unload.unitId);
+            wars::Game::Unit const& carrier = game->getUnit(e.unload.carrierId);
+            wars::Game::Tile const& next = game->getTile(e.unload.tileId);
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " unloads from unit " << game->getUnitIds().str(carrier.id()) << " to (" << next.x() << ", " << next.y()  << ")" << std::endl;
             break;
           }
           case wars::Game::EventType::DESTROY:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.destroy.unitId);
-            wars::Game::Tile const& curr = game->getTile(unit.tileId);
-            std::cout << "Unit " << unit.id << " destroyed at (" << curr.x << ", " << curr.y  << ")" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.destroy.unitId);
+            wars::Game::Tile const& curr = game->getTile(unit.tileId());
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " destroyed at (" << curr.x() << ", " << curr.y()  << ")" << std::endl;
             break;
           }
           case wars::Game::EventType::REPAIR:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.repair.unitId);
-            wars::Game::Tile const& curr = game->getTile(unit.tileId);
-            std::cout << "Unit " << unit.id << " repaired at (" << curr.x << ", " << curr.y  << "), new health = " << e.repair.newHealth << " points" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.repair.unitId);
+            wars::Game::Tile const& curr = game->getTile(unit.tileId());
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " repaired at (" << curr.x() << ", " << curr.y()  << "), new health = " << e.repair.newHealth << " points" << std::endl;
             break;
           }
           case wars::Game::EventType::BUILD:
           {
-            wars::Game::Unit const& unit = game->getUnit(*e.build.unitId);
-            wars::Game::Tile const& tile = game->getTile(*e.build.tileId);
-            std::cout << "Unit " << unit.id << " built by tile at (" << tile.x << ", " << tile.y  << ")" << std::endl;
+            wars::Game::Unit const& unit = game->getUnit(e.build.unitId);
+            wars::Game::Tile const& tile = game->getTile(e.build.tileId);
+            std::cout << "Unit " << game->getUnitIds().str(unit.id()) << " built by tile at (" << tile.x() << ", " << tile.y()  << ")" << std::endl;
             break;
           }
           case wars::Game::EventType::REGENERATE_CAPTURE_POINTS:
           {
-            wars::Game::Tile const& tile = game->getTile(*e.regenerateCapturePoints.tileId);
-            std::cout << "Tile at (" << tile.x << ", " << tile.y  << ") regenerates capture points, new value = " << e.regenerateCapturePoints.newCapturePoints << std::endl;
+            wars::Game::Tile const& tile = game->getTile(e.regenerateCapturePoints.tileId);
+            std::cout << "Tile at (" << tile.x() << ", " << tile.y()  << ") regenerates capture points, new value = " << e.regenerateCapturePoints.newCapturePoints << std::endl;
             break;
           }
           case wars::Game::EventType::PRODUCE_FUNDS:
           {
-            wars::Game::Tile const& tile = game->getTile(*e.produceFunds.tileId);
-            std::cout << "Tile at (" << tile.x << ", " << tile.y  << ") produces funds" << std::endl;
+            wars::Game::Tile const& tile = game->getTile(e.produceFunds.tileId);
+            std::cout << "Tile at (" << tile.x() << ", " << tile.y()  << ") produces funds" << std::endl;
             break;
           }
           case wars::Game::EventType::BEGIN_TURN:
@@ -155,6 +155,11 @@ namespace wars
             std::cout << "Player " << e.surrender.playerNumber << " surrenders" << std::endl;
             break;
           }
+          case wars::Game::EventType::ROLLBACK:
+          {
+            std::cout << "Rolled back " << e.rollback.numTileIds << " tiles and " << e.rollback.numUnitIds << " units" << std::endl;
+            break;
+          }
           default:
           {
             break;
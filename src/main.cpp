@@ -148,58 +148,58 @@ int main(int argc, char** argv)
     });
   });
 
-  auto moveWaitSub = input.events.moveWait.on([&gn](wars::Input::MoveWait const& event) {
+  auto moveWaitSub = input.events.moveWait.on([&gn, &game](wars::Input::MoveWait const& event) {
     Promise<bool> result = event.result;
-    json::Value params = {event.gameId, event.unitId, jsonPosition(event.destination), jsonPath(event.path)};
+    json::Value params = {event.gameId, game.getUnitIds().str(event.unitId), jsonPosition(event.destination), jsonPath(event.path)};
     std::cout << "Sending moveAndWait command with parameters " << params.toString() << std::endl;
     gn.call("moveAndWait", params).then<void>([result](json::Value const& v) mutable {
       result.fulfill(v.get("success").booleanValue());
     });
   });
 
-  auto moveAttackSub = input.events.moveAttack.on([&gn](wars::Input::MoveAttack const& event) {
+  auto moveAttackSub = input.events.moveAttack.on([&gn, &game](wars::Input::MoveAttack const& event) {
     Promise<bool> result = event.result;
-    json::Value params = {event.gameId, event.unitId, jsonPosition(event.destination), jsonPath(event.path), event.targetId};
+    json::Value params = {event.gameId, game.getUnitIds().str(event.unitId), jsonPosition(event.destination), jsonPath(event.path), game.getUnitIds().str(event.targetId)};
     gn.call("moveAndAttack", params).then<void>([result](json::Value const& v) mutable {
       result.fulfill(v.get("success").booleanValue());
     });
   });
 
-  auto moveDeploySub = input.events.moveDeploy.on([&gn](wars::Input::MoveDeploy const& event) {
+  auto moveDeploySub = input.events.moveDeploy.on([&gn, &game](wars::Input::MoveDeploy const& event) {
     Promise<bool> result = event.result;
-    json::Value params = {event.gameId, event.unitId, jsonPosition(event.destination), jsonPath(event.path)};
+    json::Value params = {event.gameId, game.getUnitIds().str(event.unitId), jsonPosition(event.destination), jsonPath(event.path)};
     gn.call("moveAndDeploy", params).then<void>([result](json::Value const& v) mutable {
       result.fulfill(v.get("success").booleanValue());
     });
   });
 
-  auto moveCaptureSub = input.events.moveCapture.on([&gn](wars::Input::MoveCapture const& event) {
+  auto moveCaptureSub = input.events.moveCapture.on([&gn, &game](wars::Input::MoveCapture const& event) {
     Promise<bool> result = event.result;
-    json::Value params = {event.gameId, event.unitId, jsonPosition(event.destination), jsonPath(event.path)};
+    json::Value params = {event.gameId, game.getUnitIds().str(event.unitId), jsonPosition(event.destination), jsonPath(event.path)};
     gn.call("moveAndCapture", params).then<void>([result](json::Value const& v) mutable {
       result.fulfill(v.get("success").booleanValue());
     });
   });
 
-  auto undeploySub = input.events.undeploy.on([&gn](wars::Input::Undeploy const& event) {
+  auto undeploySub = input.events.undeploy.on([&gn, &game](wars::Input::Undeploy const& event) {
     Promise<bool> result = event.result;
-    json::Value params = {event.gameId, event.unitId};
+    json::Value params = {event.gameId, game.getUnitIds().str(event.unitId)};
     gn.call("undeploy", params).then<void>([result](json::Value const& v) mutable {
       result.fulfill(v.get("success").booleanValue());
     });
   });
 
-  auto moveLoadSub = input.events.moveLoad.on([&gn](wars::Input::MoveLoad const& event) {
+  auto moveLoadSub = input.events.moveLoad.on([&gn, &game](wars::Input::MoveLoad const& event) {
     Promise<bool> result = event.result;
-    json::Value params = {event.gameId, event.unitId, event.carrierId, jsonPath(event.path)};
+    json::Value params = {event.gameId, game.getUnitIds().str(event.unitId), game.getUnitIds().str(event.carrierId), jsonPath(event.path)};
     gn.call("moveAndLoadInto", params).then<void>([result](json::Value const& v) mutable {
       result.fulfill(v.get("success").booleanValue());
     });
   });
 
-  auto moveUnloadSub = input.events.moveUnload.on([&gn](wars::Input::MoveUnload const& event) {
+  auto moveUnloadSub = input.events.moveUnload.on([&gn, &game](wars::Input::MoveUnload const& event) {
     Promise<bool> result = event.result;
-    json::Value params = {event.gameId, event.unitId, jsonPosition(event.destination), jsonPath(event.path), event.carriedId, jsonPosition(event.unloadDestination)};
+    json::Value params = {event.gameId, game.getUnitIds().str(event.unitId), jsonPosition(event.destination), jsonPath(event.path), game.getUnitIds().str(event.carriedId), jsonPosition(event.unloadDestination)};
     gn.call("moveAndUnload", params).then<void>([result](json::Value const& v) mutable {
       result.fulfill(v.get("success").booleanValue());
     });
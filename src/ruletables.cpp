@@ -0,0 +1,222 @@
+#include "ruletables.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+  int const UNKNOWN_MOVEMENT_TYPE = -2;
+
+  template<typename T>
+  int idLimit(std::unordered_map<int, T> const& items)
+  {
+    int limit = 0;
+    for(auto const& item : items)
+    {
+      limit = std::max(limit, item.first + 1);
+    }
+    return limit;
+  }
+}
+
+wars::RuleTables::RuleTables() :
+  numTerrainTypes(0), numMovementTypes(0), carryWords(0), unitTypes(), buildable(),
+  carryMasks(), movementCosts(), minMovementCosts(), uniformMovementCosts()
+{
+}
+
+void wars::RuleTables::compile(Rules const& rules)
+{
+  // Checked first so a throw leaves the tables as they were. A null weapon
+  // is parsed as -1.
+  for(auto const& item : rules.unitTypes)
+  {
+    int weaponIds[] = {item.second.primaryWeapon, item.second.secondaryWeapon};
+    for(int weaponId : weaponIds)
+    {
+      if(weaponId >= 0 && rules.weapons.find(weaponId) == rules.weapons.end())
+        throw std::out_of_range("Unknown weapon");
+    }
+  }
+
+  int numUnitTypes = idLimit(rules.unitTypes);
+  numMovementTypes = idLimit(rules.movementTypes);
+
+  // Effect maps may name terrain missing from the terrain table
+  numTerrainTypes = idLimit(rules.terrainTypes);
+  for(auto const& item : rules.movementTypes)
+  {
+    numTerrainTypes = std::max(numTerrainTypes, idLimit(item.second.effectMap));
+  }
+
+  int numUnitClasses = 0;
+  for(auto const& item : rules.unitTypes)
+  {
+    numUnitClasses = std::max(numUnitClasses, item.second.unitClass + 1);
+    for(int unitClassId : item.second.carryClasses)
+      numUnitClasses = std::max(numUnitClasses, unitClassId + 1);
+  }
+  carryWords = (numUnitClasses + 63) / 64;
+
+  UnitTypeInfo const invalidUnitType = {false, -1, -1, 0, 0, {-1, -1}, {-1, -1}};
+  unitTypes.assign(numUnitTypes, invalidUnitType);
+  carryMasks.assign(numUnitTypes * carryWords, 0);
+
+  for(auto const& item : rules.unitTypes)
+  {
+    UnitType const& unitType = item.second;
+    UnitTypeInfo& info = unitTypes[item.first];
+    info.valid = true;
+    info.unitClass = unitType.unitClass;
+    info.movementType = unitType.movementType;
+    info.movement = unitType.movement;
+    info.carryNum = unitType.carryNum;
+
+    // Same bounds as Game::findAttackOptions used to derive per call
+    int weaponIds[] = {unitType.primaryWeapon, unitType.secondaryWeapon};
+    for(int deployed = 0; deployed < 2; ++deployed)
+    {
+      for(int weaponId : weaponIds)
+      {
+        auto weaponIter = rules.weapons.find(weaponId);
+        if(weaponIter == rules.weapons.end())
+          continue;
+
+        Weapon const& weapon = weaponIter->second;
+        if(weapon.requireDeployed && !deployed)
+          continue;
+
+        for(auto const& range : weapon.rangeMap)
+        {
+          int& minRange = info.minRange[deployed];
+          int& maxRange = info.maxRange[deployed];
+          minRange = minRange >= 0 ? std::min(minRange, range.first) : range.first;
+          maxRange = maxRange >= 0 ? std::max(maxRange, range.first) : range.first;
+        }
+      }
+    }
+
+    for(int unitClassId : unitType.carryClasses)
+    {
+      if(unitClassId >= 0)
+        carryMasks[item.first * carryWords + unitClassId / 64] |= std::uint64_t(1) << (unitClassId % 64);
+    }
+  }
+
+  buildable.assign(idLimit(rules.terrainTypes), std::vector<int>());
+  for(auto const& item : rules.terrainTypes)
+  {
+    std::vector<int>& unitTypeIds = buildable[item.first];
+    for(auto const& unitType : rules.unitTypes)
+    {
+      if(item.second.buildTypes.count(unitType.second.unitClass))
+        unitTypeIds.push_back(unitType.first);
+    }
+    std::sort(unitTypeIds.begin(), unitTypeIds.end());
+  }
+
+  movementCosts.assign(numMovementTypes * numTerrainTypes, 1);
+  minMovementCosts.assign(numMovementTypes, UNKNOWN_MOVEMENT_TYPE);
+  uniformMovementCosts.assign(numMovementTypes, false);
+  for(auto const& item : rules.movementTypes)
+  {
+    int minCost = 1;
+    bool uniform = true;
+    for(auto const& effect : item.second.effectMap)
+    {
+      if(effect.first < 0)
+        continue;
+
+      movementCosts[item.first * numTerrainTypes + effect.first] = effect.second;
+      if(effect.second >= 0)
+        minCost = std::min(minCost, effect.second);
+      uniform = uniform && (effect.second < 0 || effect.second == 1);
+    }
+    minMovementCosts[item.first] = minCost;
+    uniformMovementCosts[item.first] = uniform;
+  }
+}
+
+int wars::RuleTables::unitClass(int unitTypeId) const
+{
+  return unitType(unitTypeId).unitClass;
+}
+
+int wars::RuleTables::movementType(int unitTypeId) const
+{
+  return unitType(unitTypeId).movementType;
+}
+
+int wars::RuleTables::movement(int unitTypeId) const
+{
+  return unitType(unitTypeId).movement;
+}
+
+int wars::RuleTables::carryNum(int unitTypeId) const
+{
+  return unitType(unitTypeId).carryNum;
+}
+
+int wars::RuleTables::minRange(int unitTypeId, bool deployed) const
+{
+  return unitType(unitTypeId).minRange[deployed ? 1 : 0];
+}
+
+int wars::RuleTables::maxRange(int unitTypeId, bool deployed) const
+{
+  return unitType(unitTypeId).maxRange[deployed ? 1 : 0];
+}
+
+std::vector<int> const& wars::RuleTables::buildableUnits(int terrainId) const
+{
+  static std::vector<int> const none;
+  if(terrainId < 0 || terrainId >= static_cast<int>(buildable.size()))
+    return none;
+
+  return buildable[terrainId];
+}
+
+bool wars::RuleTables::canCarry(int carrierTypeId, int unitClassId) const
+{
+  unitType(carrierTypeId);
+  if(unitClassId < 0 || unitClassId >= carryWords * 64)
+    return false;
+
+  std::uint64_t word = carryMasks[carrierTypeId * carryWords + unitClassId / 64];
+  return (word >> (unitClassId % 64)) & 1;
+}
+
+int wars::RuleTables::movementCost(int movementTypeId, int terrainId) const
+{
+  checkMovementType(movementTypeId);
+  if(terrainId < 0 || terrainId >= numTerrainTypes)
+    return 1;
+
+  return movementCosts[movementTypeId * numTerrainTypes + terrainId];
+}
+
+int wars::RuleTables::minMovementCost(int movementTypeId) const
+{
+  checkMovementType(movementTypeId);
+  return minMovementCosts[movementTypeId];
+}
+
+bool wars::RuleTables::uniformMovementCost(int movementTypeId) const
+{
+  checkMovementType(movementTypeId);
+  return uniformMovementCosts[movementTypeId];
+}
+
+wars::RuleTables::UnitTypeInfo const& wars::RuleTables::unitType(int unitTypeId) const
+{
+  if(unitTypeId < 0 || unitTypeId >= static_cast<int>(unitTypes.size()) || !unitTypes[unitTypeId].valid)
+    throw std::out_of_range("Unknown unit type");
+
+  return unitTypes[unitTypeId];
+}
+
+void wars::RuleTables::checkMovementType(int movementTypeId) const
+{
+  if(movementTypeId < 0 || movementTypeId >= numMovementTypes
+     || minMovementCosts[movementTypeId] == UNKNOWN_MOVEMENT_TYPE)
+    throw std::out_of_range("Unknown movement type");
+}
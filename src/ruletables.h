@@ -0,0 +1,73 @@
+#ifndef WARS_RULETABLES_H
+#define WARS_RULETABLES_H
+
+#include <vector>
+#include <cstdint>
+#include "rules.h"
+
+namespace wars
+{
+  // Rules compiled into dense tables indexed by rule IDs, with the lookups
+  // that movement, attack and build code would otherwise derive from the
+  // hash maps on every call. Unknown unit and movement type IDs throw
+  // std::out_of_range like unordered_map::at.
+  class RuleTables
+  {
+  public:
+    RuleTables();
+
+    // Throws std::out_of_range if a unit type names an unknown weapon
+    void compile(Rules const& rules);
+
+    int unitClass(int unitTypeId) const;
+    int movementType(int unitTypeId) const;
+    int movement(int unitTypeId) const;
+    int carryNum(int unitTypeId) const;
+
+    // Smallest and largest weapon range of unit type with the weapons usable
+    // when deployed or not, -1 if it has none
+    int minRange(int unitTypeId, bool deployed) const;
+    int maxRange(int unitTypeId, bool deployed) const;
+
+    // Unit types buildable on terrain in ID order, empty for unknown terrain
+    std::vector<int> const& buildableUnits(int terrainId) const;
+
+    bool canCarry(int carrierTypeId, int unitClassId) const;
+
+    // Cost of entering terrain, -1 if impassable. Terrain without an effect
+    // costs 1.
+    int movementCost(int movementTypeId, int terrainId) const;
+    // Cheapest cost of entering any terrain, at most 1
+    int minMovementCost(int movementTypeId) const;
+    // True if entering any terrain costs 1 or is impossible, movement is
+    // then a step count
+    bool uniformMovementCost(int movementTypeId) const;
+
+  private:
+    struct UnitTypeInfo
+    {
+      bool valid;
+      int unitClass;
+      int movementType;
+      int movement;
+      int carryNum;
+      int minRange[2]; // [deployed]
+      int maxRange[2];
+    };
+
+    UnitTypeInfo const& unitType(int unitTypeId) const;
+    void checkMovementType(int movementTypeId) const;
+
+    int numTerrainTypes;
+    int numMovementTypes;
+    int carryWords;
+    std::vector<UnitTypeInfo> unitTypes;
+    std::vector<std::vector<int>> buildable; // [terrain]
+    std::vector<std::uint64_t> carryMasks; // [carrier type][unit class / 64]
+    std::vector<int> movementCosts; // [movement type][terrain]
+    std::vector<int> minMovementCosts; // [movement type], -2 for unknown types
+    std::vector<bool> uniformMovementCosts; // [movement type]
+  };
+}
+
+#endif // WARS_RULETABLES_H
@@ -0,0 +1,343 @@
+#include "simstate.h"
+
+namespace
+{
+  wars::SimState::Index toIndex(wars::Handle handle);
+}
+
+wars::SimState::SimState(Game const& game) :
+  rules(&game.getRules()), state(game.getState()), inTurnNumber(game.getInTurnNumber()),
+  numTiles(0), numUnits(0), numPlayers(0), storage()
+{
+  Game::TileStore const& gameTiles = game.getTiles();
+  Game::UnitStore const& gameUnits = game.getUnits();
+  std::unordered_map<int, Game::Player> const& gamePlayers = game.getPlayers();
+
+  numPlayers = gamePlayers.size();
+  numTiles = gameTiles.size();
+  numUnits = gameUnits.size();
+  storage.resize(unitsOffset() + numUnits * sizeof(Unit));
+  Player* players = playerData();
+  Tile* tiles = tileData();
+  Unit* units = unitData();
+
+  for(Game::TileId tileId = 0; tileId < numTiles; ++tileId)
+  {
+    Tile& tile = tiles[tileId];
+    tile.x = gameTiles.x[tileId];
+    tile.y = gameTiles.y[tileId];
+    tile.type = gameTiles.type[tileId];
+    tile.subtype = gameTiles.subtype[tileId];
+    tile.capturePoints = gameTiles.capturePoints[tileId];
+    tile.unitId = toIndex(gameTiles.unitId[tileId]);
+    tile.owner = gameTiles.owner[tileId];
+    tile.beingCaptured = gameTiles.beingCaptured[tileId];
+  }
+
+  for(Game::UnitId unitId = 0; unitId < numUnits; ++unitId)
+  {
+    Unit& unit = units[unitId];
+    unit.tileId = toIndex(gameUnits.tileId[unitId]);
+    unit.carriedBy = toIndex(gameUnits.carriedBy[unitId]);
+    unit.type = gameUnits.type[unitId];
+    unit.health = gameUnits.health[unitId];
+    unit.owner = gameUnits.owner[unitId];
+    unit.flags = gameUnits.flags[unitId] | (gameUnits.exists(unitId) && gameUnits.moved(unitId) ? Game::UNIT_MOVED : 0);
+    unit.numCarried = gameUnits.carriedUnits[unitId].size();
+  }
+
+  std::size_t index = 0;
+  for(auto const& item : gamePlayers)
+  {
+    Player& player = players[index++];
+    player.playerNumber = item.second.playerNumber;
+    player.teamNumber = item.second.teamNumber;
+    player.funds = item.second.funds;
+    player.score = item.second.score;
+  }
+}
+
+void wars::SimState::apply(Game::Event const& event)
+{
+  switch(event.type)
+  {
+    case Game::EventType::MOVE:
+      moveUnit(event.move.unitId, event.move.tileId);
+      break;
+    case Game::EventType::WAIT:
+      waitUnit(event.wait.unitId);
+      break;
+    case Game::EventType::ATTACK:
+      attackUnit(event.attack.attackerId, event.attack.targetId, event.attack.damage);
+      break;
+    case Game::EventType::COUNTERATTACK:
+      counterattackUnit(event.counterattack.attackerId, event.counterattack.targetId, event.counterattack.damage);
+      break;
+    case Game::EventType::CAPTURE:
+      captureTile(event.capture.unitId, event.capture.tileId, event.capture.left);
+      break;
+    case Game::EventType::CAPTURED:
+      capturedTile(event.captured.unitId, event.captured.tileId);
+      break;
+    case Game::EventType::DEPLOY:
+      deployUnit(event.deploy.unitId);
+      break;
+    case Game::EventType::UNDEPLOY:
+      undeployUnit(event.undeploy.unitId);
+      break;
+    case Game::EventType::LOAD:
+      loadUnit(event.load.unitId, event.load.carrierId);
+      break;
+    case Game::EventType::UNLOAD:
+      unloadUnit(event.unload.unitId, event.unload.carrierId, event.unload.tileId);
+      break;
+    case Game::EventType::DESTROY:
+      destroyUnit(event.destroy.unitId);
+      break;
+    case Game::EventType::REPAIR:
+      repairUnit(event.repair.unitId, event.repair.newHealth);
+      break;
+    case Game::EventType::BUILD:
+      buildUnit(event.build.tileId, event.build.unitId, event.build.unitType, event.build.owner, event.build.health);
+      break;
+    case Game::EventType::REGENERATE_CAPTURE_POINTS:
+      regenerateCapturePointsTile(event.regenerateCapturePoints.tileId, event.regenerateCapturePoints.newCapturePoints);
+      break;
+    case Game::EventType::BEGIN_TURN:
+      beginTurn(event.beginTurn.playerNumber);
+      break;
+    case Game::EventType::END_TURN:
+      endTurn(event.endTurn.playerNumber);
+      break;
+    case Game::EventType::FINISHED:
+      finished(event.finished.winnerPlayerNumber);
+      break;
+    case Game::EventType::SURRENDER:
+      surrender(event.surrender.playerNumber);
+      break;
+    case Game::EventType::GAMEDATA:
+    case Game::EventType::PRODUCE_FUNDS:
+    case Game::EventType::TURN_TIMEOUT:
+      // Game state is not changed by these
+      break;
+    case Game::EventType::ROLLBACK:
+      // Reverts the source game, a clone rolls back by copying an earlier clone
+      break;
+  }
+}
+
+void wars::SimState::moveUnit(Game::UnitId unitId, Game::TileId tileId)
+{
+  Tile* tiles = tileData();
+  Unit& unit = unitData()[unitId];
+  if(unit.tileId != NO_INDEX)
+    tiles[unit.tileId].unitId = NO_INDEX;
+  if(tiles[tileId].unitId == NO_INDEX)
+    tiles[tileId].unitId = unitId;
+  unit.tileId = tileId;
+}
+
+void wars::SimState::waitUnit(Game::UnitId unitId)
+{
+  unitData()[unitId].flags |= Game::UNIT_MOVED;
+}
+
+void wars::SimState::attackUnit(Game::UnitId attackerId, Game::UnitId targetId, int damage)
+{
+  Unit* units = unitData();
+  units[attackerId].flags |= Game::UNIT_MOVED;
+  units[targetId].health -= damage;
+}
+
+void wars::SimState::counterattackUnit(Game::UnitId, Game::UnitId targetId, int damage)
+{
+  unitData()[targetId].health -= damage;
+}
+
+void wars::SimState::captureTile(Game::UnitId unitId, Game::TileId tileId, int left)
+{
+  Tile& tile = tileData()[tileId];
+  unitData()[unitId].flags |= Game::UNIT_MOVED;
+  tile.capturePoints = left;
+  tile.beingCaptured = true;
+}
+
+void wars::SimState::capturedTile(Game::UnitId unitId, Game::TileId tileId)
+{
+  Tile& tile = tileData()[tileId];
+  tile.capturePoints = 1;
+  tile.beingCaptured = false;
+  tile.owner = unitData()[unitId].owner;
+}
+
+void wars::SimState::deployUnit(Game::UnitId unitId)
+{
+  unitData()[unitId].flags |= Game::UNIT_MOVED | Game::UNIT_DEPLOYED;
+}
+
+void wars::SimState::undeployUnit(Game::UnitId unitId)
+{
+  std::uint8_t& flags = unitData()[unitId].flags;
+  flags = (flags | Game::UNIT_MOVED) & ~Game::UNIT_DEPLOYED;
+}
+
+void wars::SimState::loadUnit(Game::UnitId unitId, Game::UnitId carrierId)
+{
+  // The unit has already moved onto the carrier tile
+  Unit* units = unitData();
+  Unit& unit = units[unitId];
+  unit.tileId = NO_INDEX;
+  unit.carriedBy = carrierId;
+  unit.flags |= Game::UNIT_MOVED;
+  units[carrierId].numCarried += 1;
+}
+
+void wars::SimState::unloadUnit(Game::UnitId unitId, Game::UnitId carrierId, Game::TileId tileId)
+{
+  Unit* units = unitData();
+  Unit& unit = units[unitId];
+  unit.tileId = tileId;
+  unit.carriedBy = NO_INDEX;
+  unit.flags |= Game::UNIT_MOVED;
+  tileData()[tileId].unitId = unitId;
+  units[carrierId].flags |= Game::UNIT_MOVED;
+  units[carrierId].numCarried -= 1;
+}
+
+void wars::SimState::destroyUnit(Game::UnitId unitId)
+{
+  Unit* units = unitData();
+  Unit& unit = units[unitId];
+  if(unit.tileId != NO_INDEX)
+  {
+    tileData()[unit.tileId].unitId = NO_INDEX;
+  }
+  else if(unit.carriedBy != NO_INDEX)
+  {
+    units[unit.carriedBy].numCarried -= 1;
+  }
+
+  // Carried units go down with their carrier
+  for(Game::UnitId carriedId = 0; unit.numCarried > 0 && carriedId < numUnits; ++carriedId)
+  {
+    if(units[carriedId].carriedBy == unitId && (units[carriedId].flags & Game::UNIT_ALIVE))
+      destroyUnit(carriedId);
+  }
+
+  unit.tileId = NO_INDEX;
+  unit.carriedBy = NO_INDEX;
+  unit.numCarried = 0;
+  unit.flags = 0;
+}
+
+void wars::SimState::repairUnit(Game::UnitId unitId, int newHealth)
+{
+  unitData()[unitId].health = newHealth;
+}
+
+void wars::SimState::buildUnit(Game::TileId tileId, Game::UnitId unitId, int unitType, int owner, int health)
+{
+  // New handles are past every unit of the source game
+  if(unitId >= numUnits)
+    storage.resize(unitsOffset() + (unitId + std::size_t(1)) * sizeof(Unit));
+
+  // Clear slots skipped over, they belong to units never seen
+  Unit* units = unitData();
+  for(; numUnits <= unitId; ++numUnits)
+  {
+    units[numUnits].flags = 0;
+    units[numUnits].tileId = NO_INDEX;
+    units[numUnits].carriedBy = NO_INDEX;
+    units[numUnits].numCarried = 0;
+  }
+
+  Unit& unit = units[unitId];
+  unit.tileId = tileId;
+  unit.carriedBy = NO_INDEX;
+  unit.type = unitType;
+  unit.health = health;
+  unit.owner = owner;
+  unit.flags = Game::UNIT_ALIVE | Game::UNIT_MOVED;
+  unit.numCarried = 0;
+  tileData()[tileId].unitId = unitId;
+}
+
+void wars::SimState::regenerateCapturePointsTile(Game::TileId tileId, int newCapturePoints)
+{
+  Tile& tile = tileData()[tileId];
+  tile.capturePoints = newCapturePoints;
+  tile.beingCaptured = false;
+}
+
+void wars::SimState::beginTurn(int playerNumber)
+{
+  inTurnNumber = playerNumber;
+}
+
+void wars::SimState::endTurn(int)
+{
+  Unit* units = unitData();
+  for(std::size_t i = 0; i < numUnits; ++i)
+  {
+    units[i].flags &= ~Game::UNIT_MOVED;
+  }
+}
+
+void wars::SimState::finished(int)
+{
+  state = Game::State::FINISHED;
+}
+
+void wars::SimState::surrender(int playerNumber)
+{
+  for(Game::UnitId unitId = 0; unitId < numUnits; ++unitId)
+  {
+    // Carried units may already be gone with their carrier
+    if(unitExists(unitId) && unitData()[unitId].owner == playerNumber)
+      destroyUnit(unitId);
+  }
+
+  Tile* tiles = tileData();
+  for(std::size_t i = 0; i < numTiles; ++i)
+  {
+    if(tiles[i].owner == playerNumber)
+    {
+      tiles[i].owner = Game::NEUTRAL_PLAYER_NUMBER;
+    }
+  }
+}
+
+wars::SimState::Player const* wars::SimState::getPlayer(int playerNumber) const
+{
+  Player const* players = playerData();
+  for(std::size_t i = 0; i < numPlayers; ++i)
+  {
+    if(players[i].playerNumber == playerNumber)
+      return &players[i];
+  }
+  return nullptr;
+}
+
+bool wars::SimState::areAllies(int playerNumber1, int playerNumber2) const
+{
+  if(playerNumber1 == 0)
+  {
+    return playerNumber2 == 0;
+  }
+  else if(playerNumber2 == 0)
+  {
+    return false;
+  }
+
+  Player const* player1 = getPlayer(playerNumber1);
+  Player const* player2 = getPlayer(playerNumber2);
+  return player1 && player2 && player1->teamNumber == player2->teamNumber;
+}
+
+namespace
+{
+  wars::SimState::Index toIndex(wars::Handle handle)
+  {
+    return handle == wars::INVALID_HANDLE ? wars::SimState::NO_INDEX : static_cast<wars::SimState::Index>(handle);
+  }
+}
@@ -0,0 +1,121 @@
+#ifndef WARS_SIMSTATE_H
+#define WARS_SIMSTATE_H
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "game.h"
+
+namespace wars
+{
+  // Flat snapshot of a game for lookahead. Players, tiles and units live
+  // in one buffer sized from the source game and hold no pointers, so a
+  // clone is a single copy of the buffer. Copying into a clone of the same
+  // game reuses its buffer. Ids are the TileId/UnitId handles of the source
+  // Game.
+  class SimState
+  {
+  public:
+    typedef std::uint32_t Index;
+    static const Index NO_INDEX = 0xffffffff;
+
+    struct Tile
+    {
+      std::int32_t x;
+      std::int32_t y;
+      Index unitId;
+      std::int16_t type;
+      std::int16_t subtype;
+      std::int16_t capturePoints;
+      std::int8_t owner;
+      std::uint8_t beingCaptured;
+    };
+
+    struct Unit
+    {
+      Index tileId;
+      Index carriedBy;
+      std::int16_t type;
+      std::int16_t health;
+      std::int8_t owner;
+      std::uint8_t flags; // Game::UnitFlag
+      std::uint8_t numCarried;
+    };
+
+    struct Player
+    {
+      int playerNumber;
+      int teamNumber;
+      int funds;
+      int score;
+    };
+
+    explicit SimState(Game const& game);
+
+    // Applies event the way Game applies it
+    void apply(Game::Event const& event);
+
+    void moveUnit(Game::UnitId unitId, Game::TileId tileId);
+    void waitUnit(Game::UnitId unitId);
+    void attackUnit(Game::UnitId attackerId, Game::UnitId targetId, int damage);
+    void counterattackUnit(Game::UnitId attackerId, Game::UnitId targetId, int damage);
+    void captureTile(Game::UnitId unitId, Game::TileId tileId, int left);
+    void capturedTile(Game::UnitId unitId, Game::TileId tileId);
+    void deployUnit(Game::UnitId unitId);
+    void undeployUnit(Game::UnitId unitId);
+    void loadUnit(Game::UnitId unitId, Game::UnitId carrierId);
+    void unloadUnit(Game::UnitId unitId, Game::UnitId carrierId, Game::TileId tileId);
+    void destroyUnit(Game::UnitId unitId);
+    void repairUnit(Game::UnitId unitId, int newHealth);
+    // Grows the unit storage if unitId is past it
+    void buildUnit(Game::TileId tileId, Game::UnitId unitId, int unitType, int owner, int health);
+    void regenerateCapturePointsTile(Game::TileId tileId, int newCapturePoints);
+    void beginTurn(int playerNumber);
+    void endTurn(int playerNumber);
+    void finished(int winnerPlayerNumber);
+    void surrender(int playerNumber);
+
+    Rules const& getRules() const { return *rules; }
+    std::size_t getNumTiles() const { return numTiles; }
+    std::size_t getNumUnits() const { return numUnits; }
+    std::size_t getNumPlayers() const { return numPlayers; }
+    std::size_t getStorageSize() const { return storage.size(); }
+    Tile const& getTile(Game::TileId tileId) const { return tileData()[tileId]; }
+    Unit const& getUnit(Game::UnitId unitId) const { return unitData()[unitId]; }
+    Player const& getPlayerAt(std::size_t index) const { return playerData()[index]; }
+    // Returns nullptr for unknown player numbers
+    Player const* getPlayer(int playerNumber) const;
+    bool unitExists(Game::UnitId unitId) const { return unitId < numUnits && (unitData()[unitId].flags & Game::UNIT_ALIVE); }
+    bool areAllies(int playerNumber1, int playerNumber2) const;
+    int getInTurnNumber() const { return inTurnNumber; }
+    Game::State getState() const { return state; }
+
+  private:
+    // Players, then tiles, then units so built units only grow the end
+    Player* playerData() { return reinterpret_cast<Player*>(storage.data()); }
+    Player const* playerData() const { return reinterpret_cast<Player const*>(storage.data()); }
+    Tile* tileData() { return reinterpret_cast<Tile*>(storage.data() + tilesOffset()); }
+    Tile const* tileData() const { return reinterpret_cast<Tile const*>(storage.data() + tilesOffset()); }
+    Unit* unitData() { return reinterpret_cast<Unit*>(storage.data() + unitsOffset()); }
+    Unit const* unitData() const { return reinterpret_cast<Unit const*>(storage.data() + unitsOffset()); }
+    std::size_t tilesOffset() const { return numPlayers * sizeof(Player); }
+    std::size_t unitsOffset() const { return tilesOffset() + numTiles * sizeof(Tile); }
+
+    Rules const* rules;
+    Game::State state;
+    int inTurnNumber;
+    std::uint32_t numTiles;
+    std::uint32_t numUnits;
+    std::uint32_t numPlayers;
+    std::vector<unsigned char> storage;
+  };
+
+  static_assert(std::is_trivially_copyable<SimState::Player>::value
+                && std::is_trivially_copyable<SimState::Tile>::value
+                && std::is_trivially_copyable<SimState::Unit>::value, "SimState clones must be plain copies");
+  static_assert(sizeof(SimState::Player) % alignof(SimState::Unit) == 0
+                && sizeof(SimState::Tile) % alignof(SimState::Unit) == 0, "SimState storage must keep units aligned");
+}
+
+#endif // WARS_SIMSTATE_H
@@ -0,0 +1,296 @@
+#include "threatmap.h"
+#include <algorithm>
+
+wars::ThreatMap::ThreatMap(Game& game) :
+  game(game), eventSub(), unitThreats(), dirtyUnits(), playerThreats(),
+  tileStamps(), nearUnitIds(), nearXs(), nearYs(), nearDistances(), stamp(0), reset(true)
+{
+  eventSub = game.events().on([this](Game::Event const& event) {
+    handleEvent(event);
+  });
+}
+
+wars::ThreatMap::~ThreatMap()
+{
+  eventSub.unsubscribe();
+}
+
+int wars::ThreatMap::damage(int playerNumber, Game::TileId tileId)
+{
+  update();
+  auto iter = playerThreats.find(playerNumber);
+  return iter != playerThreats.end() ? iter->second.damage.at(tileId) : 0;
+}
+
+int wars::ThreatMap::attackers(int playerNumber, Game::TileId tileId)
+{
+  update();
+  auto iter = playerThreats.find(playerNumber);
+  return iter != playerThreats.end() ? iter->second.attackers.at(tileId).size() : 0;
+}
+
+void wars::ThreatMap::handleEvent(Game::Event const& event)
+{
+  // Events arrive before the game applies them, positions are still the old ones
+  Game::UnitStore const& units = game.getUnits();
+
+  switch(event.type)
+  {
+    case Game::EventType::GAMEDATA:
+    {
+      reset = true;
+      break;
+    }
+    case Game::EventType::ROLLBACK:
+    {
+      // Comes after the state is reverted, the reverted tiles cover both
+      // ends of every reverted move
+      for(std::size_t i = 0; i < event.rollback.numTileIds; ++i)
+        markNear(event.rollback.tileIds[i]);
+      for(std::size_t i = 0; i < event.rollback.numUnitIds; ++i)
+        markUnit(event.rollback.unitIds[i]);
+      break;
+    }
+    case Game::EventType::MOVE:
+    {
+      markNear(units.tileId.at(event.move.unitId));
+      markNear(event.move.tileId);
+      markUnit(event.move.unitId);
+      break;
+    }
+    case Game::EventType::DESTROY:
+    {
+      markNear(units.tileId.at(event.destroy.unitId));
+      markUnit(event.destroy.unitId);
+      break;
+    }
+    case Game::EventType::BUILD:
+    {
+      markNear(event.build.tileId);
+      markUnit(event.build.unitId);
+      break;
+    }
+    case Game::EventType::DEPLOY:
+    {
+      markUnit(event.deploy.unitId);
+      break;
+    }
+    case Game::EventType::UNDEPLOY:
+    {
+      markUnit(event.undeploy.unitId);
+      break;
+    }
+    case Game::EventType::LOAD:
+    {
+      markNear(units.tileId.at(event.load.carrierId));
+      markUnit(event.load.unitId);
+      break;
+    }
+    case Game::EventType::UNLOAD:
+    {
+      markNear(units.tileId.at(event.unload.carrierId));
+      markNear(event.unload.tileId);
+      markUnit(event.unload.unitId);
+      break;
+    }
+    case Game::EventType::ATTACK:
+    {
+      markUnit(event.attack.targetId);
+      break;
+    }
+    case Game::EventType::COUNTERATTACK:
+    {
+      markUnit(event.counterattack.targetId);
+      break;
+    }
+    case Game::EventType::REPAIR:
+    {
+      markUnit(event.repair.unitId);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void wars::ThreatMap::markUnit(Game::UnitId unitId)
+{
+  if(unitId >= unitThreats.size())
+    unitThreats.resize(unitId + 1);
+
+  UnitThreat& threat = unitThreats[unitId];
+  if(!threat.dirty)
+  {
+    threat.dirty = true;
+    dirtyUnits.push_back(unitId);
+  }
+}
+
+void wars::ThreatMap::markNear(Game::TileId tileId)
+{
+  if(tileId == Game::NO_TILE || reset)
+    return;
+
+  Game::TileStore const& tiles = game.getTiles();
+  Game::Coordinates const pos = {tiles.x.at(tileId), tiles.y.at(tileId)};
+  nearUnitIds.clear();
+  nearXs.clear();
+  nearYs.clear();
+  for(Game::UnitId unitId = 0; unitId < unitThreats.size(); ++unitId)
+  {
+    UnitThreat const& threat = unitThreats[unitId];
+    if(!threat.active || threat.dirty)
+      continue;
+
+    if(threat.radius < 0)
+    {
+      markUnit(unitId);
+      continue;
+    }
+
+    nearUnitIds.push_back(unitId);
+    nearXs.push_back(tiles.x[threat.origin]);
+    nearYs.push_back(tiles.y[threat.origin]);
+  }
+
+  // Distance is symmetric, one batch from pos covers every origin
+  nearDistances.resize(nearUnitIds.size());
+  game.calculateDistances(pos, nearXs.data(), nearYs.data(), nearDistances.data(), nearUnitIds.size());
+  for(std::size_t i = 0; i < nearUnitIds.size(); ++i)
+  {
+    if(nearDistances[i] <= unitThreats[nearUnitIds[i]].radius)
+      markUnit(nearUnitIds[i]);
+  }
+}
+
+void wars::ThreatMap::update()
+{
+  Game::UnitStore const& units = game.getUnits();
+
+  if(reset)
+  {
+    reset = false;
+    unitThreats.clear();
+    dirtyUnits.clear();
+    playerThreats.clear();
+    tileStamps.assign(game.getTiles().size(), 0);
+    stamp = 0;
+
+    for(Game::UnitId unitId = 0; unitId < units.size(); ++unitId)
+    {
+      markUnit(unitId);
+    }
+  }
+
+  for(Game::UnitId unitId : dirtyUnits)
+  {
+    removeThreat(unitId);
+    unitThreats[unitId].dirty = false;
+    if(units.exists(unitId) && units.tileId[unitId] != Game::NO_TILE)
+      addThreat(unitId);
+  }
+  dirtyUnits.clear();
+}
+
+void wars::ThreatMap::removeThreat(Game::UnitId unitId)
+{
+  UnitThreat& threat = unitThreats[unitId];
+  if(!threat.active)
+    return;
+
+  PlayerThreat& player = playerThreat(threat.owner);
+  for(Game::TileId tileId : threat.tileIds)
+  {
+    std::vector<Game::UnitId>& attackers = player.attackers[tileId];
+    attackers.erase(std::find(attackers.begin(), attackers.end(), unitId));
+
+    // Find the next strongest attacker if this one was the strongest
+    if(threat.damage == player.damage[tileId])
+    {
+      int damage = 0;
+      for(Game::UnitId attackerId : attackers)
+      {
+        damage = std::max(damage, unitThreats[attackerId].damage);
+      }
+      player.damage[tileId] = damage;
+    }
+  }
+
+  threat.tileIds.clear();
+  threat.active = false;
+}
+
+void wars::ThreatMap::addThreat(Game::UnitId unitId)
+{
+  RuleTables const& ruleTables = game.getRuleTables();
+  DamageTable const& damageTable = game.getDamageTable();
+  Game::TileStore const& tiles = game.getTiles();
+  Game::Unit const unit = game.getUnit(unitId);
+  int const unitTypeId = unit.type();
+
+  // Best power and ranges of weapons usable next turn
+  int power = -1;
+  int minRange = ruleTables.minRange(unitTypeId, unit.deployed());
+  int maxRange = ruleTables.maxRange(unitTypeId, unit.deployed());
+  std::vector<bool> ranges(maxRange + 1, false);
+  for(int distance = std::max(minRange, 0); distance <= maxRange; ++distance)
+  {
+    int distancePower = damageTable.maxPower(unitTypeId, unit.deployed(), distance);
+    ranges[distance] = distancePower >= 0;
+    power = std::max(power, distancePower);
+  }
+
+  UnitThreat& threat = unitThreats[unitId];
+  threat.owner = unit.owner();
+  threat.origin = unit.tileId();
+  threat.damage = DamageTable::damage(unit.health(), 0, power, 0);
+  threat.active = true;
+
+  // Same bound as the movement options cache in Game
+  int minCost = ruleTables.minMovementCost(ruleTables.movementType(unitTypeId));
+  threat.radius = minCost > 0 ? ruleTables.movement(unitTypeId) / minCost : -1;
+
+  if(power < 0)
+    return;
+
+  // Deployed units fire from where they stand
+  std::vector<Game::Coordinates> positions;
+  if(unit.deployed())
+    positions.push_back({tiles.x[unit.tileId()], tiles.y[unit.tileId()]});
+  else
+    positions = game.findMovementOptions(unitId);
+
+  if(tileStamps.size() != tiles.size())
+    tileStamps.assign(tiles.size(), 0);
+  stamp += 1;
+
+  for(Game::Coordinates const& position : positions)
+  {
+    game.forEachTileInRange(position, minRange, maxRange, [&](Game::TileId tileId, int distance) {
+      if(ranges[distance] && tileStamps[tileId] != stamp)
+      {
+        tileStamps[tileId] = stamp;
+        threat.tileIds.push_back(tileId);
+      }
+    });
+  }
+
+  PlayerThreat& player = playerThreat(threat.owner);
+  for(Game::TileId tileId : threat.tileIds)
+  {
+    player.attackers[tileId].push_back(unitId);
+    player.damage[tileId] = std::max(player.damage[tileId], threat.damage);
+  }
+}
+
+wars::ThreatMap::PlayerThreat& wars::ThreatMap::playerThreat(int playerNumber)
+{
+  PlayerThreat& player = playerThreats[playerNumber];
+  std::size_t numTiles = game.getTiles().size();
+  if(player.damage.size() != numTiles)
+  {
+    player.damage.assign(numTiles, 0);
+    player.attackers.assign(numTiles, {});
+  }
+  return player;
+}
@@ -0,0 +1,73 @@
+#ifndef WARS_THREATMAP_H
+#define WARS_THREATMAP_H
+
+#include <vector>
+#include <unordered_map>
+#include "game.h"
+
+namespace wars
+{
+  // Tiles each player could strike next turn, kept up to date from game
+  // events. Event handlers only mark the affected units, their threat is
+  // recomputed on the next query.
+  class ThreatMap
+  {
+  public:
+    explicit ThreatMap(Game& game);
+    ~ThreatMap();
+
+    ThreatMap(ThreatMap const&) = delete;
+    ThreatMap& operator=(ThreatMap const&) = delete;
+
+    // Highest damage any unit of playerNumber could deal to a unit on tileId
+    // next turn before terrain and unit defense, 0 if none
+    int damage(int playerNumber, Game::TileId tileId);
+    // Number of units of playerNumber that could attack tileId next turn
+    int attackers(int playerNumber, Game::TileId tileId);
+
+  private:
+    // Threat contributed by a single unit
+    struct UnitThreat
+    {
+      UnitThreat() : tileIds(), damage(0), owner(0), origin(Game::NO_TILE), radius(0), active(false), dirty(false) {}
+
+      std::vector<Game::TileId> tileIds;
+      int damage;
+      int owner;
+      Game::TileId origin;
+      int radius; // Occupancy changes within radius of origin can change tileIds, -1 for any
+      bool active;
+      bool dirty;
+    };
+
+    struct PlayerThreat
+    {
+      std::vector<int> damage;
+      std::vector<std::vector<Game::UnitId>> attackers;
+    };
+
+    void handleEvent(Game::Event const& event);
+    void markUnit(Game::UnitId unitId);
+    void markNear(Game::TileId tileId);
+    void update();
+    void removeThreat(Game::UnitId unitId);
+    void addThreat(Game::UnitId unitId);
+    PlayerThreat& playerThreat(int playerNumber);
+
+    Game& game;
+    Stream<Game::Event>::Subscription eventSub;
+    std::vector<UnitThreat> unitThreats;
+    std::vector<Game::UnitId> dirtyUnits;
+    std::unordered_map<int, PlayerThreat> playerThreats;
+    std::vector<unsigned int> tileStamps;
+    // markNear candidates with their origins packed for the distance kernel
+    std::vector<Game::UnitId> nearUnitIds;
+    std::vector<int> nearXs;
+    std::vector<int> nearYs;
+    std::vector<int> nearDistances;
+    unsigned int stamp;
+    bool reset;
+  };
+}
+
+#endif // WARS_THREATMAP_H
@@ -0,0 +1,104 @@
+#include "workerpool.h"
+
+wars::WorkerPool::WorkerPool(unsigned int numThreads) :
+  threads(), runMutex(), mutex(), wake(), done(), task(nullptr), count(0), next(0),
+  active(0), generation(0), stopping(false), error()
+{
+  if(numThreads == 0)
+  {
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+  }
+
+  for(unsigned int i = 0; i < numThreads; ++i)
+  {
+    threads.emplace_back(&WorkerPool::work, this, i + 1);
+  }
+}
+
+wars::WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+
+  for(std::thread& thread : threads)
+  {
+    thread.join();
+  }
+}
+
+unsigned int wars::WorkerPool::concurrency() const
+{
+  return threads.size() + 1;
+}
+
+void wars::WorkerPool::parallelFor(std::size_t count, Task const& task)
+{
+  std::lock_guard<std::mutex> runLock(runMutex);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->task = &task;
+    this->count = count;
+    next = 0;
+    active = threads.size();
+    error = nullptr;
+    generation += 1;
+  }
+  wake.notify_all();
+
+  runTasks(0);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [this]() { return active == 0; });
+  this->task = nullptr;
+
+  if(error)
+  {
+    std::exception_ptr e = error;
+    error = nullptr;
+    std::rethrow_exception(e);
+  }
+}
+
+void wars::WorkerPool::work(unsigned int worker)
+{
+  unsigned int seen = 0;
+  while(true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+      if(stopping)
+        return;
+      seen = generation;
+    }
+
+    runTasks(worker);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    active -= 1;
+    if(active == 0)
+      done.notify_one();
+  }
+}
+
+void wars::WorkerPool::runTasks(unsigned int worker)
+{
+  for(std::size_t i = next++; i < count; i = next++)
+  {
+    try
+    {
+      (*task)(i, worker);
+    }
+    catch(...)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if(!error)
+        error = std::current_exception();
+    }
+  }
+}
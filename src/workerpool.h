@@ -0,0 +1,56 @@
+#ifndef WARS_WORKERPOOL_H
+#define WARS_WORKERPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <cstddef>
+
+namespace wars
+{
+  // Fixed set of worker threads for data parallel loops. The calling thread
+  // takes part in the work as worker 0.
+  class WorkerPool
+  {
+  public:
+    typedef std::function<void(std::size_t index, unsigned int worker)> Task;
+
+    // Zero threads means one per hardware thread besides the caller
+    explicit WorkerPool(unsigned int numThreads = 0);
+    ~WorkerPool();
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    // Number of distinct worker indices passed to tasks
+    unsigned int concurrency() const;
+
+    // Calls task(i, worker) for every i in [0, count) and returns when all
+    // calls are done. Rethrows the first exception thrown by a task.
+    void parallelFor(std::size_t count, Task const& task);
+
+  private:
+    void work(unsigned int worker);
+    void runTasks(unsigned int worker);
+
+    std::vector<std::thread> threads;
+    std::mutex runMutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    Task const* task;
+    std::size_t count;
+    std::atomic<std::size_t> next;
+    unsigned int active;
+    unsigned int generation;
+    bool stopping;
+    std::exception_ptr error;
+  };
+}
+
+#endif // WARS_WORKERPOOL_H